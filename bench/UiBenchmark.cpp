@@ -0,0 +1,264 @@
+// Headless UI benchmark: feeds SearchAssetsUI synthetic results at fixed
+// rates, renders its component tree into an off-screen Screen at the frame
+// rate the terminal would, and reports frame times and input latency.
+// Frame times include moving the queued results into the list, which the
+// UI thread does before every draw.
+//
+//   SearchAssetsUiBench [--rates 10,1000,100000] [--seconds 3] [--fps 60]
+//                       [--width 160] [--height 50]
+
+#include "UI.h"
+#include <ftxui/component/event.hpp>
+#include <ftxui/dom/elements.hpp>
+#include <ftxui/screen/screen.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+// Reaches into the UI the way the app's own threads do: results through the
+// engine's result callback, keystrokes through the component tree
+class UiBenchmark
+{
+public:
+    explicit UiBenchmark(SearchAssetsUI &ui) : ui_(ui) {}
+
+    ftxui::Component root() const { return ui_.main_container_; }
+    ftxui::Component filter_input() const { return ui_.input_filter_; }
+    ftxui::Component results_list() const { return ui_.results_list_; }
+
+    void add_result(const SearchResult &result) { ui_.add_result(result); }
+    void set_searching(bool searching) { ui_.is_searching_ = searching; }
+    void reset() { ui_.reset_search(); }
+
+private:
+    SearchAssetsUI &ui_;
+};
+
+namespace {
+
+struct Options
+{
+    std::vector<double> rates{10, 100, 1000, 10000, 100000};
+    double seconds = 3.0;
+    int fps = 60;
+    int width = 160;
+    int height = 50;
+};
+
+// Stands in for SearchEngine::search: emits unique results at a steady
+// rate from its own thread, through the same callback the engine uses
+class SyntheticSearch
+{
+public:
+    void start(double rate, UiBenchmark &bench)
+    {
+        stop_ = false;
+        emitted_ = 0;
+        thread_ = std::thread([this, rate, &bench]()
+                              {
+            auto begin = Clock::now();
+            while (!stop_) {
+                double elapsed = std::chrono::duration<double>(Clock::now() - begin).count();
+                auto due = static_cast<size_t>(rate * elapsed);
+                while (emitted_ < due && !stop_) {
+                    bench.add_result(make_result(emitted_));
+                    ++emitted_;
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            } });
+    }
+
+    size_t stop()
+    {
+        stop_ = true;
+        if (thread_.joinable())
+            thread_.join();
+        return emitted_;
+    }
+
+private:
+    static SearchResult make_result(size_t index)
+    {
+        char name[64];
+        std::snprintf(name, sizeof(name), "SM_Rock_%07zu.uasset", index);
+        return SearchResult("/Project/Content/Environment/Rocks/" + std::string(name), "Binary content match", 1);
+    }
+
+    std::thread thread_;
+    std::atomic<bool> stop_{false};
+    std::atomic<size_t> emitted_{0};
+};
+
+struct Percentiles
+{
+    double p50 = 0.0;
+    double p90 = 0.0;
+    double p99 = 0.0;
+    double max = 0.0;
+};
+
+Percentiles percentiles(std::vector<double> samples)
+{
+    Percentiles result;
+    if (samples.empty())
+        return result;
+
+    std::sort(samples.begin(), samples.end());
+    auto at = [&samples](double q)
+    {
+        return samples[std::min(samples.size() - 1, static_cast<size_t>(q * samples.size()))];
+    };
+    result.p50 = at(0.50);
+    result.p90 = at(0.90);
+    result.p99 = at(0.99);
+    result.max = samples.back();
+    return result;
+}
+
+double milliseconds(Clock::duration duration)
+{
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+std::vector<double> parse_rates(const std::string &list)
+{
+    std::vector<double> rates;
+    size_t start = 0;
+    while (start <= list.size())
+    {
+        size_t end = list.find(',', start);
+        if (end == std::string::npos)
+            end = list.size();
+        if (end > start)
+            rates.push_back(std::atof(list.substr(start, end - start).c_str()));
+        start = end + 1;
+    }
+    return rates;
+}
+
+bool parse_options(int argc, char **argv, Options &options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (i + 1 >= argc)
+        {
+            std::fprintf(stderr, "Missing value for %s\n", arg.c_str());
+            return false;
+        }
+        std::string value = argv[++i];
+        if (arg == "--rates")
+            options.rates = parse_rates(value);
+        else if (arg == "--seconds")
+            options.seconds = std::atof(value.c_str());
+        else if (arg == "--fps")
+            options.fps = std::max(1, std::atoi(value.c_str()));
+        else if (arg == "--width")
+            options.width = std::max(20, std::atoi(value.c_str()));
+        else if (arg == "--height")
+            options.height = std::max(10, std::atoi(value.c_str()));
+        else
+        {
+            std::fprintf(stderr, "Unknown option %s\n", arg.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    Options options;
+    if (!parse_options(argc, argv, options))
+    {
+        std::fprintf(stderr, "Usage: %s [--rates 10,1000,100000] [--seconds 3] [--fps 60] [--width 160] [--height 50]\n",
+                     argv[0]);
+        return 1;
+    }
+
+    SearchAssetsUI ui;
+    UiBenchmark bench(ui);
+    auto screen = ftxui::Screen::Create(ftxui::Dimension::Fixed(options.width), ftxui::Dimension::Fixed(options.height));
+
+    // Keystrokes a user sends while results stream in: narrow the filter,
+    // move the selection, widen the filter again
+    const std::vector<std::pair<ftxui::Component, ftxui::Event>> inputs = {
+        {bench.filter_input(), ftxui::Event::Character('7')},
+        {bench.results_list(), ftxui::Event::ArrowDown},
+        {bench.filter_input(), ftxui::Event::Backspace},
+        {bench.results_list(), ftxui::Event::ArrowDown},
+    };
+    const int input_every = std::max(1, options.fps / 10); // About 10 keys per second
+
+    std::printf("%10s %10s %9s %7s | %-31s | %-23s\n", "target/s", "actual/s", "results", "frames",
+                "frame ms  p50    p90    p99    max", "input ms  p50    p99    max");
+
+    const auto frame_interval = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / options.fps));
+    for (double rate : options.rates)
+    {
+        bench.reset();
+        bench.set_searching(true);
+
+        SyntheticSearch search;
+        std::vector<double> frame_times;
+        std::vector<double> input_latencies;
+
+        auto begin = Clock::now();
+        auto end = begin + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(options.seconds));
+        auto next_frame = begin;
+        search.start(rate, bench);
+
+        for (size_t frame = 0; Clock::now() < end; ++frame)
+        {
+            // The interactive loop handles pending events, then draws
+            auto event_start = Clock::now();
+            bool has_input = frame % input_every == 0;
+            if (has_input)
+            {
+                // Focus the target, then dispatch from the root like the loop does
+                const auto &input = inputs[(frame / input_every) % inputs.size()];
+                input.first->TakeFocus();
+                bench.root()->OnEvent(input.second);
+            }
+
+            auto draw_start = Clock::now();
+            screen.Clear();
+            ftxui::Render(screen, bench.root()->Render());
+            auto draw_end = Clock::now();
+
+            frame_times.push_back(milliseconds(draw_end - draw_start));
+            if (has_input)
+                input_latencies.push_back(milliseconds(draw_end - event_start));
+
+            next_frame += frame_interval;
+            if (next_frame > draw_end)
+                std::this_thread::sleep_until(next_frame);
+            else
+                next_frame = draw_end; // Behind: drop frames instead of bursting
+        }
+
+        size_t emitted = search.stop();
+        double elapsed = std::chrono::duration<double>(Clock::now() - begin).count();
+        bench.set_searching(false);
+
+        auto frames = percentiles(frame_times);
+        auto input = percentiles(input_latencies);
+        std::printf("%10.0f %10.0f %9zu %7zu |        %6.2f %6.2f %6.2f %6.2f |        %6.2f %6.2f %6.2f\n",
+                    rate, emitted / elapsed, emitted, frame_times.size(),
+                    frames.p50, frames.p90, frames.p99, frames.max,
+                    input.p50, input.p99, input.max);
+        std::fflush(stdout);
+    }
+
+    bench.reset();
+    return 0;
+}
@@ -0,0 +1,155 @@
+#include "CommandPipe.h"
+
+#ifndef _WIN32
+#include <cerrno>
+#include <csignal>
+#include <pthread.h>
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+
+namespace {
+
+// Blocks SIGPIPE on the calling thread while it writes, so a consumer that
+// exits early fails the write instead of killing the process. A SIGPIPE the
+// write raised is consumed before the previous mask comes back.
+class ScopedSigpipeBlock {
+public:
+    ScopedSigpipeBlock() {
+        sigemptyset(&sigpipe_);
+        sigaddset(&sigpipe_, SIGPIPE);
+        sigset_t pending;
+        sigpending(&pending);
+        was_pending_ = sigismember(&pending, SIGPIPE) == 1;
+        blocked_ = pthread_sigmask(SIG_BLOCK, &sigpipe_, &previous_) == 0;
+    }
+
+    ~ScopedSigpipeBlock() {
+        if (!blocked_) {
+            return;
+        }
+        sigset_t pending;
+        sigpending(&pending);
+        if (!was_pending_ && sigismember(&pending, SIGPIPE) == 1) {
+            int signal = 0;
+            sigwait(&sigpipe_, &signal);
+        }
+        pthread_sigmask(SIG_SETMASK, &previous_, nullptr);
+    }
+
+    ScopedSigpipeBlock(const ScopedSigpipeBlock&) = delete;
+    ScopedSigpipeBlock& operator=(const ScopedSigpipeBlock&) = delete;
+
+private:
+    sigset_t sigpipe_;
+    sigset_t previous_;
+    bool was_pending_ = false;
+    bool blocked_ = false;
+};
+
+} // namespace
+#endif
+
+bool CommandPipe::open(const std::vector<std::string>& argv) {
+    close();
+    failed_ = false;
+    if (argv.empty()) {
+        return false;
+    }
+
+#ifdef _WIN32
+    return false;
+#else
+    int fds[2];
+    if (pipe(fds) != 0) {
+        return false;
+    }
+    // Only the child's stdin (a dup) may outlive exec, or EOF never arrives
+    fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+    fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, fds[0], STDIN_FILENO);
+    posix_spawn_file_actions_addclose(&actions, fds[0]);
+    posix_spawn_file_actions_addclose(&actions, fds[1]);
+
+    // Silence the child: it must not draw over the terminal UI
+    posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, "/dev/null", O_WRONLY, 0);
+    posix_spawn_file_actions_addopen(&actions, STDERR_FILENO, "/dev/null", O_WRONLY, 0);
+
+    std::vector<char*> args;
+    for (const auto& arg : argv) {
+        args.push_back(const_cast<char*>(arg.c_str()));
+    }
+    args.push_back(nullptr);
+
+    pid_t pid = -1;
+    int rc = posix_spawnp(&pid, args[0], &actions, nullptr, args.data(), environ);
+    posix_spawn_file_actions_destroy(&actions);
+    ::close(fds[0]);
+
+    if (rc != 0) {
+        ::close(fds[1]);
+        return false;
+    }
+
+    fd_ = fds[1];
+    pid_ = static_cast<int>(pid);
+    return true;
+#endif
+}
+
+bool CommandPipe::open_first(const std::vector<std::vector<std::string>>& candidates) {
+    for (const auto& argv : candidates) {
+        if (open(argv)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool CommandPipe::write(std::string_view data) {
+#ifdef _WIN32
+    (void)data;
+    return false;
+#else
+    ScopedSigpipeBlock sigpipe_block;
+    while (fd_ != -1 && !data.empty()) {
+        ssize_t written = ::write(fd_, data.data(), data.size());
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            failed_ = true;
+            return false;
+        }
+        data.remove_prefix(static_cast<size_t>(written));
+    }
+    return fd_ != -1;
+#endif
+}
+
+bool CommandPipe::close() {
+#ifdef _WIN32
+    return false;
+#else
+    if (fd_ == -1) {
+        return false;
+    }
+    ::close(fd_);
+    fd_ = -1;
+
+    int status = 0;
+    pid_t waited = -1;
+    do {
+        waited = waitpid(static_cast<pid_t>(pid_), &status, 0);
+    } while (waited == -1 && errno == EINTR);
+    pid_ = -1;
+
+    return !failed_ && waited != -1 && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+#endif
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Write end of a child process's standard input. The program is started
+// directly (posix_spawnp), never through a shell, so arguments and data need
+// no quoting and the data is not limited by command line length.
+// Not available on Windows, where open() fails.
+class CommandPipe
+{
+public:
+    CommandPipe() = default;
+    ~CommandPipe() { close(); }
+
+    CommandPipe(const CommandPipe &) = delete;
+    CommandPipe &operator=(const CommandPipe &) = delete;
+
+    // argv[0] is looked up in PATH. False if it could not be started.
+    bool open(const std::vector<std::string> &argv);
+
+    // Opens the first command that starts
+    bool open_first(const std::vector<std::vector<std::string>> &candidates);
+
+    bool write(std::string_view data);
+
+    // Closes the child's input and waits for it; true if it exited with 0
+    bool close();
+
+    bool is_open() const { return fd_ != -1; }
+
+private:
+    int fd_ = -1;
+    int pid_ = -1;
+    bool failed_ = false;
+};
@@ -0,0 +1,167 @@
+#include "ContentFingerprint.h"
+#include <cstring>
+
+#ifndef _WIN32
+#include <sys/stat.h>
+#endif
+
+namespace content_fingerprint {
+
+namespace {
+
+constexpr uint64_t prime1 = 0x9E3779B185EBCA87ULL;
+constexpr uint64_t prime2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr uint64_t prime3 = 0x165667B19E3779F9ULL;
+constexpr uint64_t prime4 = 0x85EBCA77C2B2AE63ULL;
+constexpr uint64_t prime5 = 0x27D4EB2F165667C5ULL;
+
+// Size of each block hashed by sampled_hash
+constexpr size_t sample_block = 4096;
+
+inline uint64_t rotl(uint64_t value, int bits) {
+    return (value << bits) | (value >> (64 - bits));
+}
+
+inline uint64_t read64(const unsigned char* p) {
+    uint64_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+inline uint32_t read32(const unsigned char* p) {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+inline uint64_t round(uint64_t acc, uint64_t input) {
+    acc += input * prime2;
+    acc = rotl(acc, 31);
+    return acc * prime1;
+}
+
+inline uint64_t merge_round(uint64_t acc, uint64_t value) {
+    acc ^= round(0, value);
+    return acc * prime1 + prime4;
+}
+
+} // namespace
+
+uint64_t xxhash64(const void* data, size_t size, uint64_t seed) {
+    const auto* p = static_cast<const unsigned char*>(data);
+    const unsigned char* end = p + size;
+    uint64_t hash;
+
+    if (size >= 32) {
+        uint64_t v1 = seed + prime1 + prime2;
+        uint64_t v2 = seed + prime2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - prime1;
+
+        for (; end - p >= 32; p += 32) {
+            v1 = round(v1, read64(p));
+            v2 = round(v2, read64(p + 8));
+            v3 = round(v3, read64(p + 16));
+            v4 = round(v4, read64(p + 24));
+        }
+
+        hash = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+        hash = merge_round(hash, v1);
+        hash = merge_round(hash, v2);
+        hash = merge_round(hash, v3);
+        hash = merge_round(hash, v4);
+    } else {
+        hash = seed + prime5;
+    }
+
+    hash += static_cast<uint64_t>(size);
+
+    for (; end - p >= 8; p += 8) {
+        hash ^= round(0, read64(p));
+        hash = rotl(hash, 27) * prime1 + prime4;
+    }
+    if (end - p >= 4) {
+        hash ^= static_cast<uint64_t>(read32(p)) * prime1;
+        hash = rotl(hash, 23) * prime2 + prime3;
+        p += 4;
+    }
+    for (; p < end; ++p) {
+        hash ^= (*p) * prime5;
+        hash = rotl(hash, 11) * prime1;
+    }
+
+    hash ^= hash >> 33;
+    hash *= prime2;
+    hash ^= hash >> 29;
+    hash *= prime3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+uint64_t sampled_hash(std::string_view content) {
+    // Small contents are hashed whole; larger ones by their first, middle and last block
+    const uint64_t size = content.size();
+    if (size <= 3 * sample_block) {
+        return xxhash64(content.data(), content.size(), size);
+    }
+
+    char buffer[3 * sample_block];
+    const size_t offsets[] = {0, content.size() / 2 - sample_block / 2, content.size() - sample_block};
+    for (size_t i = 0; i < 3; ++i) {
+        std::memcpy(buffer + i * sample_block, content.data() + offsets[i], sample_block);
+    }
+    return xxhash64(buffer, sizeof(buffer), size);
+}
+
+size_t FileIdentityHash::operator()(const FileIdentity& id) const {
+    uint64_t fields[] = {id.device, id.inode, static_cast<uint64_t>(id.mtime), id.size};
+    return static_cast<size_t>(xxhash64(fields, sizeof(fields)));
+}
+
+bool read_file_identity(const std::filesystem::path& path, FileIdentity& identity) {
+#ifdef _WIN32
+    // No cheap inode here: the absolute path stands in for it
+    std::error_code ec;
+    auto write_time = std::filesystem::last_write_time(path, ec);
+    if (ec) return false;
+    auto size = std::filesystem::file_size(path, ec);
+    if (ec) return false;
+
+    std::string key = std::filesystem::absolute(path, ec).string();
+    identity.device = 0;
+    identity.inode = xxhash64(key.data(), key.size());
+    identity.mtime = static_cast<int64_t>(write_time.time_since_epoch().count());
+    identity.size = size;
+#else
+    struct stat sb;
+    if (stat(path.c_str(), &sb) == -1) {
+        return false;
+    }
+    identity.device = static_cast<uint64_t>(sb.st_dev);
+    identity.inode = static_cast<uint64_t>(sb.st_ino);
+#if defined(__APPLE__)
+    identity.mtime = static_cast<int64_t>(sb.st_mtimespec.tv_sec) * 1000000000LL + sb.st_mtimespec.tv_nsec;
+#else
+    identity.mtime = static_cast<int64_t>(sb.st_mtim.tv_sec) * 1000000000LL + sb.st_mtim.tv_nsec;
+#endif
+    identity.size = static_cast<uint64_t>(sb.st_size);
+#endif
+    return true;
+}
+
+bool FingerprintCache::lookup(const FileIdentity& identity, uint64_t& full_hash) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto found = entries_.find(identity);
+    if (found == entries_.end()) {
+        return false;
+    }
+    full_hash = found->second;
+    return true;
+}
+
+void FingerprintCache::store(const FileIdentity& identity, uint64_t full_hash) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_[identity] = full_hash;
+}
+
+} // namespace content_fingerprint
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+
+// Content fingerprints used to scan byte-identical files only once.
+// Candidates are narrowed in two steps: a hash of the size and a few sampled
+// blocks, then a full XXH64 of the content.
+namespace content_fingerprint
+{
+    uint64_t xxhash64(const void *data, size_t size, uint64_t seed = 0);
+
+    // Hash of the size and the first, middle and last blocks of the content.
+    // Only touches those blocks, so a mapping is not read in full.
+    uint64_t sampled_hash(std::string_view content);
+
+    // Which file (device, inode) at which version (mtime, size)
+    struct FileIdentity
+    {
+        uint64_t device = 0;
+        uint64_t inode = 0;
+        int64_t mtime = 0;
+        uint64_t size = 0;
+
+        bool operator==(const FileIdentity &other) const = default;
+    };
+
+    struct FileIdentityHash
+    {
+        size_t operator()(const FileIdentity &id) const;
+    };
+
+    bool read_file_identity(const std::filesystem::path &path, FileIdentity &identity);
+
+    // Hashes keyed by file identity, kept across searches so unchanged files
+    // are never re-hashed. Thread safe.
+    class FingerprintCache
+    {
+    public:
+        // False if the file is not cached at this identity
+        bool lookup(const FileIdentity &identity, uint64_t &full_hash) const;
+        void store(const FileIdentity &identity, uint64_t full_hash);
+
+    private:
+        mutable std::mutex mutex_;
+        std::unordered_map<FileIdentity, uint64_t, FileIdentityHash> entries_;
+    };
+}
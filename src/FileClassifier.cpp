@@ -0,0 +1,147 @@
+#include "FileClassifier.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace file_classifier {
+
+namespace {
+
+// FPackageFileSummary::Tag, little endian
+constexpr uint32_t package_file_tag = 0x9E2A83C1;
+
+// Above this the sample is treated as compressed or encoded payload
+constexpr double compressed_entropy = 7.5;
+
+bool read_int32(std::string_view content, size_t& offset, int32_t& value) {
+    if (offset + sizeof(value) > content.size()) {
+        return false;
+    }
+    std::memcpy(&value, content.data() + offset, sizeof(value));
+    offset += sizeof(value);
+    return true;
+}
+
+bool is_text_extension(const std::filesystem::path& path) {
+    static const char* const text_extensions[] = {
+        ".ini", ".json", ".uproject", ".uplugin", ".txt", ".csv", ".xml",
+        ".md", ".h", ".cpp", ".cs", ".py", ".usf", ".ush", ".yaml", ".yml"
+    };
+
+    std::string extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    return std::any_of(std::begin(text_extensions), std::end(text_extensions),
+                       [&extension](const char* text) { return extension == text; });
+}
+
+} // namespace
+
+FileKind classify(const std::filesystem::path& path, std::string_view content) {
+    if (content.size() >= 4) {
+        uint32_t tag = 0;
+        std::memcpy(&tag, content.data(), sizeof(tag));
+        if (tag == package_file_tag) {
+            return FileKind::UnrealPackage;
+        }
+    }
+
+    if (is_text_extension(path)) {
+        return FileKind::Text;
+    }
+
+    std::string_view sample = content.substr(0, sample_size);
+    if (sample.find('\0') == std::string_view::npos) {
+        return FileKind::Text;
+    }
+
+    return sample_entropy(sample) > compressed_entropy ? FileKind::Compressed : FileKind::Binary;
+}
+
+std::optional<FileKind> guess_kind(const std::filesystem::path& path) {
+    if (is_text_extension(path)) {
+        return FileKind::Text;
+    }
+
+    std::string extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    if (extension == ".uasset" || extension == ".umap") {
+        return FileKind::UnrealPackage;
+    }
+    return std::nullopt;
+}
+
+size_t unreal_package_header_size(std::string_view content) {
+    size_t offset = 4; // Tag
+    int32_t legacy_version = 0;
+
+    // Only UE4/UE5 summaries (negative legacy versions) are understood
+    if (!read_int32(content, offset, legacy_version) || legacy_version >= 0 || legacy_version < -9) {
+        return 0;
+    }
+
+    if (legacy_version != -4) {
+        offset += 4; // LegacyUE3Version
+    }
+    offset += 4; // FileVersionUE4
+    if (legacy_version <= -8) {
+        offset += 4; // FileVersionUE5
+    }
+    offset += 4; // FileVersionLicenseeUE4
+
+    if (legacy_version <= -2) {
+        int32_t custom_version_count = 0;
+        if (!read_int32(content, offset, custom_version_count) || custom_version_count < 0) {
+            return 0;
+        }
+
+        // Optimized format is Guid + Version, the oldest one Tag + Version.
+        // The Guid+FriendlyName format in between is not supported.
+        size_t entry_size = 0;
+        if (legacy_version < -5) {
+            entry_size = 20;
+        } else if (legacy_version == -2) {
+            entry_size = 8;
+        } else {
+            return 0;
+        }
+        offset += static_cast<size_t>(custom_version_count) * entry_size;
+    }
+
+    // Newer summaries store a 20 byte saved hash before the header size
+    for (size_t skip : {size_t{0}, size_t{20}}) {
+        size_t field = offset + skip;
+        int32_t total_header_size = 0;
+        if (read_int32(content, field, total_header_size) &&
+            total_header_size > static_cast<int32_t>(field) &&
+            static_cast<size_t>(total_header_size) <= content.size()) {
+            return static_cast<size_t>(total_header_size);
+        }
+    }
+
+    return 0;
+}
+
+double sample_entropy(std::string_view sample) {
+    if (sample.empty()) {
+        return 0.0;
+    }
+
+    std::array<size_t, 256> histogram{};
+    for (char c : sample) {
+        ++histogram[static_cast<unsigned char>(c)];
+    }
+
+    double entropy = 0.0;
+    const double total = static_cast<double>(sample.size());
+    for (size_t count : histogram) {
+        if (count > 0) {
+            double p = static_cast<double>(count) / total;
+            entropy -= p * std::log2(p);
+        }
+    }
+    return entropy;
+}
+
+} // namespace file_classifier
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <filesystem>
+#include <optional>
+#include <string_view>
+
+// Content type of a file, decided from its first bytes before any matching
+enum class FileKind
+{
+    UnrealPackage, // .uasset/.umap with the package file tag
+    Text,          // Config and source files, or no NUL in the sample
+    Binary,        // Anything else with a NUL in the sample
+    Compressed,    // Binary whose sample looks like compressed/encoded payload
+    Count
+};
+
+// How much of a file of a given kind is matched
+enum class ScanPolicy
+{
+    Skip,       // Not matched at all
+    HeaderOnly, // Package summary and tables, or the first N bytes for other kinds
+    Full
+};
+
+using ScanPolicies = std::array<ScanPolicy, static_cast<size_t>(FileKind::Count)>;
+
+namespace file_classifier
+{
+    // Bytes sampled for the NUL and entropy checks
+    constexpr size_t sample_size = 4096;
+
+    FileKind classify(const std::filesystem::path &path, std::string_view content);
+
+    // Likely kind from the name alone, before the file is read: packages
+    // (.uasset/.umap) and known text extensions. Empty when only the
+    // content can tell.
+    std::optional<FileKind> guess_kind(const std::filesystem::path &path);
+
+    // TotalHeaderSize from an Unreal package summary: the part of the file
+    // holding the name, import and export tables. 0 if it can't be read.
+    size_t unreal_package_header_size(std::string_view content);
+
+    // Shannon entropy of the sample, in bits per byte
+    double sample_entropy(std::string_view sample);
+}
@@ -0,0 +1,273 @@
+#include "IgnoreRules.h"
+#include <fstream>
+
+namespace {
+
+// Index of the ']' closing the class opened at 'open', or npos. A ']' right
+// after the opening bracket (or its negation) is a member, not the end.
+size_t class_end(std::string_view pattern, size_t open) {
+    size_t first = open + 1;
+    if (first < pattern.size() && (pattern[first] == '!' || pattern[first] == '^')) ++first;
+    return pattern.find(']', first + 1);
+}
+
+} // namespace
+
+bool IgnoreRules::load(const std::filesystem::path& ignore_file) {
+    std::ifstream file(ignore_file);
+    if (!file) {
+        return false;
+    }
+
+    std::error_code ec;
+    base_ = std::filesystem::absolute(ignore_file, ec).parent_path();
+
+    std::string line;
+    while (std::getline(file, line)) {
+        add_rule(line);
+    }
+    return true;
+}
+
+void IgnoreRules::add_rule(std::string_view line) {
+    while (!line.empty() && (line.back() == '\r' || line.back() == ' ' || line.back() == '\t')) {
+        line.remove_suffix(1);
+    }
+    if (line.empty() || line[0] == '#') {
+        return;
+    }
+
+    RuleRef rule{false, false, 0};
+    if (line[0] == '!') {
+        rule.negated = true;
+        line.remove_prefix(1);
+    } else if (line.size() > 1 && line[0] == '\\' && (line[1] == '#' || line[1] == '!')) {
+        line.remove_prefix(1);
+    }
+
+    while (!line.empty() && line.back() == '/') {
+        rule.directory_only = true;
+        line.remove_suffix(1);
+    }
+
+    bool anchored = false;
+    if (!line.empty() && line[0] == '/') {
+        anchored = true;
+        line.remove_prefix(1);
+    } else if (line.substr(0, 3) == "**/" && line.find('/', 3) == std::string_view::npos) {
+        // "**/name" is the same as "name"
+        line.remove_prefix(3);
+    } else {
+        anchored = line.find('/') != std::string_view::npos;
+    }
+
+    if (line.empty()) {
+        return;
+    }
+
+    rule.index = rule_count_++;
+    bool is_glob = line.find_first_of("*?[\\") != std::string_view::npos;
+
+    if (!is_glob && !anchored) {
+        name_rules_[std::string(line)].push_back(rule);
+    } else if (!is_glob) {
+        size_t node = 0;
+        size_t start = 0;
+        while (start <= line.size()) {
+            size_t end = line.find('/', start);
+            if (end == std::string_view::npos) end = line.size();
+            std::string component(line.substr(start, end - start));
+            start = end + 1;
+            if (component.empty()) continue;
+
+            auto found = path_trie_[node].children.find(component);
+            if (found == path_trie_[node].children.end()) {
+                path_trie_.emplace_back();
+                found = path_trie_[node].children.emplace(std::move(component), path_trie_.size() - 1).first;
+            }
+            node = found->second;
+        }
+        path_trie_[node].rules.push_back(rule);
+    } else {
+        globs_.push_back({compile_glob(line), anchored, rule});
+    }
+}
+
+std::vector<IgnoreRules::Token> IgnoreRules::compile_glob(std::string_view pattern) {
+    std::vector<Token> tokens;
+    auto append_literal = [&tokens](char c) {
+        if (tokens.empty() || tokens.back().kind != Token::Kind::Literal) {
+            tokens.push_back({Token::Kind::Literal, {}, {}});
+        }
+        tokens.back().literal += c;
+    };
+
+    size_t i = 0;
+    while (i < pattern.size()) {
+        char c = pattern[i];
+        if (c == '*') {
+            size_t stars = 1;
+            while (i + stars < pattern.size() && pattern[i + stars] == '*') ++stars;
+            i += stars;
+            if (stars == 1) {
+                tokens.push_back({Token::Kind::Star, {}, {}});
+            } else if (i < pattern.size() && pattern[i] == '/') {
+                tokens.push_back({Token::Kind::DoubleStarSlash, {}, {}});
+                ++i;
+            } else {
+                tokens.push_back({Token::Kind::DoubleStar, {}, {}});
+            }
+        } else if (c == '?') {
+            tokens.push_back({Token::Kind::Question, {}, {}});
+            ++i;
+        } else if (c == '[' && class_end(pattern, i) != std::string_view::npos) {
+            Token token{Token::Kind::Class, {}, {}};
+            size_t j = i + 1;
+            bool negate = pattern[j] == '!' || pattern[j] == '^';
+            if (negate) ++j;
+
+            size_t close = class_end(pattern, i);
+            for (; j < close; ++j) {
+                auto low = static_cast<unsigned char>(pattern[j]);
+                auto high = low;
+                if (j + 2 < close && pattern[j + 1] == '-') {
+                    high = static_cast<unsigned char>(pattern[j + 2]);
+                    j += 2;
+                }
+                for (unsigned v = low; v <= high; ++v) token.set.set(v);
+            }
+            if (negate) {
+                token.set.flip();
+                token.set.reset('/');
+            }
+            tokens.push_back(std::move(token));
+            i = close + 1;
+        } else if (c == '\\' && i + 1 < pattern.size()) {
+            append_literal(pattern[i + 1]);
+            i += 2;
+        } else {
+            append_literal(c);
+            ++i;
+        }
+    }
+    return tokens;
+}
+
+bool IgnoreRules::match_tokens(const std::vector<Token>& tokens, size_t token, std::string_view text) {
+    if (token == tokens.size()) {
+        return text.empty();
+    }
+
+    const Token& current = tokens[token];
+    switch (current.kind) {
+    case Token::Kind::Literal:
+        return text.substr(0, current.literal.size()) == current.literal &&
+               match_tokens(tokens, token + 1, text.substr(current.literal.size()));
+
+    case Token::Kind::Question:
+        return !text.empty() && text[0] != '/' && match_tokens(tokens, token + 1, text.substr(1));
+
+    case Token::Kind::Class:
+        return !text.empty() && current.set.test(static_cast<unsigned char>(text[0])) &&
+               match_tokens(tokens, token + 1, text.substr(1));
+
+    case Token::Kind::Star:
+        for (size_t i = 0; i <= text.size(); ++i) {
+            if (match_tokens(tokens, token + 1, text.substr(i))) return true;
+            if (i < text.size() && text[i] == '/') break;
+        }
+        return false;
+
+    case Token::Kind::DoubleStar:
+        for (size_t i = 0; i <= text.size(); ++i) {
+            if (match_tokens(tokens, token + 1, text.substr(i))) return true;
+        }
+        return false;
+
+    case Token::Kind::DoubleStarSlash:
+        if (match_tokens(tokens, token + 1, text)) return true;
+        for (size_t i = 0; i < text.size(); ++i) {
+            if (text[i] == '/' && match_tokens(tokens, token + 1, text.substr(i + 1))) return true;
+        }
+        return false;
+    }
+    return false;
+}
+
+void IgnoreRules::consider(const RuleRef& rule, bool is_directory, const RuleRef*& best) {
+    if (rule.directory_only && !is_directory) {
+        return;
+    }
+    if (best == nullptr || rule.index > best->index) {
+        best = &rule;
+    }
+}
+
+bool IgnoreRules::is_ignored(std::string_view relative_path, bool is_directory) const {
+    if (rule_count_ == 0 || relative_path.empty()) {
+        return false;
+    }
+
+    const RuleRef* best = nullptr;
+
+    size_t slash = relative_path.rfind('/');
+    std::string_view name = slash == std::string_view::npos ? relative_path : relative_path.substr(slash + 1);
+
+    if (!name_rules_.empty()) {
+        auto found = name_rules_.find(std::string(name));
+        if (found != name_rules_.end()) {
+            for (const auto& rule : found->second) consider(rule, is_directory, best);
+        }
+    }
+
+    if (path_trie_.size() > 1) {
+        size_t node = 0;
+        size_t start = 0;
+        bool complete = true;
+        while (start < relative_path.size()) {
+            size_t end = relative_path.find('/', start);
+            if (end == std::string_view::npos) end = relative_path.size();
+            auto found = path_trie_[node].children.find(std::string(relative_path.substr(start, end - start)));
+            if (found == path_trie_[node].children.end()) {
+                complete = false;
+                break;
+            }
+            node = found->second;
+            start = end + 1;
+        }
+        if (complete) {
+            for (const auto& rule : path_trie_[node].rules) consider(rule, is_directory, best);
+        }
+    }
+
+    for (const auto& glob : globs_) {
+        // A glob that can't beat the current winner isn't worth matching
+        if ((best != nullptr && glob.rule.index < best->index) || (glob.rule.directory_only && !is_directory)) {
+            continue;
+        }
+        if (match_tokens(glob.tokens, 0, glob.anchored ? relative_path : name)) {
+            consider(glob.rule, is_directory, best);
+        }
+    }
+
+    return best != nullptr && !best->negated;
+}
+
+std::string IgnoreRules::relative_to_base(const std::filesystem::path& path) const {
+    std::error_code ec;
+    auto absolute = std::filesystem::absolute(path, ec).lexically_normal();
+    auto relative = absolute.lexically_relative(base_.lexically_normal());
+
+    std::string result = relative.generic_string();
+    if (relative.empty() || result.rfind("..", 0) == 0) {
+        // Outside the base: rules only see names below the path itself
+        return "";
+    }
+    if (result == ".") {
+        return "";
+    }
+    while (!result.empty() && result.back() == '/') {
+        result.pop_back();
+    }
+    return result;
+}
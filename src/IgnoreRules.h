@@ -0,0 +1,84 @@
+#pragma once
+
+#include <bitset>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// gitignore-style exclusion rules, normally read from a .searchignore file.
+// Supported syntax: '#' comments, '!' negation, trailing '/' for directories
+// only, leading or inner '/' to anchor to the base directory, and the globs
+// '*', '?', '[...]' and '**'. The last matching rule wins.
+//
+// Rules are compiled by shape: plain names go to a hash map, anchored plain
+// paths to a trie of path components, and only real globs are matched token
+// by token.
+class IgnoreRules
+{
+public:
+    static constexpr const char *file_name = ".searchignore";
+
+    // Loads rules from a file; the file's directory becomes the base
+    bool load(const std::filesystem::path &ignore_file);
+
+    void add_rule(std::string_view line);
+    void set_base(const std::filesystem::path &base) { base_ = base; }
+    const std::filesystem::path &base() const { return base_; }
+    bool empty() const { return rule_count_ == 0; }
+
+    // relative_path is relative to the base and uses '/' separators
+    bool is_ignored(std::string_view relative_path, bool is_directory) const;
+
+    // Converts a path to the base-relative form; empty for the base itself
+    // and for paths outside it
+    std::string relative_to_base(const std::filesystem::path &path) const;
+
+private:
+    struct Token
+    {
+        enum class Kind
+        {
+            Literal,
+            Star,           // '*': anything but '/'
+            Question,       // '?': one character but '/'
+            Class,          // '[...]'
+            DoubleStar,     // '**': anything, including '/'
+            DoubleStarSlash // '**/': nothing, or anything ending in '/'
+        };
+        Kind kind;
+        std::string literal;
+        std::bitset<256> set;
+    };
+
+    struct RuleRef
+    {
+        bool directory_only;
+        bool negated;
+        size_t index; // Position in the file; later rules win
+    };
+
+    struct Glob
+    {
+        std::vector<Token> tokens;
+        bool anchored; // Matched against the whole relative path, not the name
+        RuleRef rule;
+    };
+
+    struct TrieNode
+    {
+        std::unordered_map<std::string, size_t> children;
+        std::vector<RuleRef> rules;
+    };
+
+    static std::vector<Token> compile_glob(std::string_view pattern);
+    static bool match_tokens(const std::vector<Token> &tokens, size_t token, std::string_view text);
+    static void consider(const RuleRef &rule, bool is_directory, const RuleRef *&best);
+
+    std::filesystem::path base_;
+    size_t rule_count_ = 0;
+    std::unordered_map<std::string, std::vector<RuleRef>> name_rules_;
+    std::vector<TrieNode> path_trie_{TrieNode{}};
+    std::vector<Glob> globs_;
+};
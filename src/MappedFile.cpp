@@ -0,0 +1,160 @@
+#include "MappedFile.h"
+#include <algorithm>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+#ifdef _WIN32
+        file_ = std::exchange(other.file_, nullptr);
+        mapping_ = std::exchange(other.mapping_, nullptr);
+#else
+        fd_ = std::exchange(other.fd_, -1);
+#endif
+    }
+    return *this;
+}
+
+bool MappedFile::open(const std::filesystem::path& path, bool populate) {
+    close();
+
+#ifdef _WIN32
+    (void)populate;
+    HANDLE hFile = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                               nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (hFile == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    file_ = hFile;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(hFile, &fileSize) || fileSize.QuadPart == 0) {
+        close();
+        return false;
+    }
+    size_ = static_cast<size_t>(fileSize.QuadPart);
+
+    HANDLE hMapping = CreateFileMappingA(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (hMapping == nullptr) {
+        close();
+        return false;
+    }
+    mapping_ = hMapping;
+
+    data_ = static_cast<const char*>(MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0));
+    if (data_ == nullptr) {
+        close();
+        return false;
+    }
+#else
+    fd_ = ::open(path.c_str(), O_RDONLY);
+    if (fd_ == -1) {
+        return false;
+    }
+
+    struct stat sb;
+    if (fstat(fd_, &sb) == -1 || sb.st_size == 0) {
+        close();
+        return false;
+    }
+    size_ = static_cast<size_t>(sb.st_size);
+
+    int flags = MAP_PRIVATE;
+#ifdef MAP_POPULATE
+    if (populate) {
+        flags |= MAP_POPULATE;
+    }
+#else
+    (void)populate;
+#endif
+    void* mapping = mmap(nullptr, size_, PROT_READ, flags, fd_, 0);
+    if (mapping == MAP_FAILED) {
+        close();
+        return false;
+    }
+    data_ = static_cast<const char*>(mapping);
+#endif
+
+    return true;
+}
+
+void MappedFile::disable_readahead() const {
+#ifndef _WIN32
+    if (data_ != nullptr) {
+        madvise(const_cast<char*>(data_), size_, MADV_RANDOM);
+    }
+#endif
+}
+
+size_t MappedFile::prefault(size_t length, const std::atomic<bool>& stop) const {
+    constexpr size_t page_size = 4096;
+    if (data_ == nullptr) {
+        return 0;
+    }
+    length = std::min(length, size_);
+
+#ifndef _WIN32
+    // Let the kernel issue large reads for the whole range up front, also
+    // when read-around is disabled and faults would read page by page
+    if (length > page_size) {
+        madvise(const_cast<char*>(data_), length, MADV_WILLNEED);
+    }
+#endif
+
+    volatile char sink = 0;
+    size_t pages = 0;
+    for (size_t offset = 0; offset < length; offset += page_size) {
+        // Huge files are checked for cancellation every 4 MB
+        if ((pages & 1023) == 1023 && stop.load(std::memory_order_relaxed)) {
+            return 0;
+        }
+        sink = data_[offset];
+        ++pages;
+    }
+    (void)sink;
+    return pages;
+}
+
+void MappedFile::close() {
+#ifdef _WIN32
+    if (data_ != nullptr) {
+        UnmapViewOfFile(data_);
+    }
+    if (mapping_ != nullptr) {
+        CloseHandle(static_cast<HANDLE>(mapping_));
+    }
+    if (file_ != nullptr) {
+        CloseHandle(static_cast<HANDLE>(file_));
+    }
+    file_ = nullptr;
+    mapping_ = nullptr;
+#else
+    if (data_ != nullptr) {
+        munmap(const_cast<char*>(data_), size_);
+    }
+    if (fd_ != -1) {
+        ::close(fd_);
+    }
+    fd_ = -1;
+#endif
+    data_ = nullptr;
+    size_ = 0;
+}
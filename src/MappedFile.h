@@ -0,0 +1,50 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <filesystem>
+#include <string_view>
+
+// Read-only memory mapping of a whole file, unmapped on destruction
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::filesystem::path &path) { open(path); }
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    MappedFile(MappedFile &&other) noexcept;
+    MappedFile &operator=(MappedFile &&other) noexcept;
+
+    // Fails for missing, unreadable and empty files. `populate` reads the
+    // whole file while mapping (MAP_POPULATE, where available): one call
+    // instead of a fault per page, worth it for small files.
+    bool open(const std::filesystem::path &path, bool populate = false);
+    void close();
+
+    bool is_open() const { return data_ != nullptr; }
+    std::string_view content() const { return std::string_view(data_, size_); }
+    size_t size() const { return size_; }
+
+    // Turns off the kernel's read-around on page faults, which would read
+    // most of a file on the first access. Afterwards only faulted pages and
+    // ranges passed to prefault() are read from the device.
+    void disable_readahead() const;
+
+    // Reads one byte per page of the first `length` bytes so later accesses
+    // do not block on the device; the rest of the file is left unread.
+    // Returns the number of pages touched (0 if stopped early).
+    size_t prefault(size_t length, const std::atomic<bool> &stop) const;
+
+private:
+    const char *data_ = nullptr;
+    size_t size_ = 0;
+#ifdef _WIN32
+    void *file_ = nullptr;
+    void *mapping_ = nullptr;
+#else
+    int fd_ = -1;
+#endif
+};
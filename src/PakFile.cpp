@@ -0,0 +1,548 @@
+#include "PakFile.h"
+#include <algorithm>
+#include <cstring>
+
+#ifdef SEARCHASSETS_HAS_ZLIB
+#include <zlib.h>
+#endif
+
+namespace {
+
+constexpr uint32_t pak_magic = 0x5A6F12E1;
+constexpr size_t footer_scan_bytes = 512;
+constexpr size_t footer_size = 44; // Magic, version, index offset and size, index hash
+constexpr size_t hash_size = 20;
+constexpr size_t compression_name_length = 32;
+
+constexpr int32_t version_no_timestamps = 2;
+constexpr int32_t version_compression_encryption = 3;
+constexpr int32_t version_index_encryption = 4;
+constexpr int32_t version_relative_chunk_offsets = 5;
+constexpr int32_t version_fname_compression = 8;
+constexpr int32_t version_frozen_index = 9;
+constexpr int32_t version_path_hash_index = 10;
+constexpr int32_t version_latest = 11;
+
+// Size of the entry header stored in front of each entry's data
+uint64_t serialized_size(int32_t version, bool compressed, size_t block_count) {
+    uint64_t size = 8 + 8 + 8 + 4 + hash_size;
+    if (version < version_no_timestamps) {
+        size += 8;
+    }
+    if (version >= version_compression_encryption) {
+        size += 1 + 4;
+        if (compressed) {
+            size += 4 + 16 * static_cast<uint64_t>(block_count);
+        }
+    }
+    return size;
+}
+
+void append_utf8(std::string& out, uint32_t code_point) {
+    if (code_point < 0x80) {
+        out.push_back(static_cast<char>(code_point));
+    } else if (code_point < 0x800) {
+        out.push_back(static_cast<char>(0xC0 | (code_point >> 6)));
+        out.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    } else if (code_point < 0x10000) {
+        out.push_back(static_cast<char>(0xE0 | (code_point >> 12)));
+        out.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    } else {
+        out.push_back(static_cast<char>(0xF0 | (code_point >> 18)));
+        out.push_back(static_cast<char>(0x80 | ((code_point >> 12) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    }
+}
+
+// Bounds-checked little-endian reader over part of the container
+struct Reader {
+    std::string_view data;
+    size_t offset = 0;
+
+    template <typename T>
+    bool scalar(T& value) {
+        if (data.size() - offset < sizeof(T)) return false;
+        std::memcpy(&value, data.data() + offset, sizeof(T));
+        offset += sizeof(T);
+        return true;
+    }
+
+    bool skip(size_t bytes) {
+        if (data.size() - offset < bytes) return false;
+        offset += bytes;
+        return true;
+    }
+
+    // FString: length including the terminator, negative for UTF-16
+    bool string(std::string& value) {
+        int32_t length = 0;
+        if (!scalar(length) || length == INT32_MIN) return false;
+        value.clear();
+        if (length == 0) return true;
+
+        if (length > 0) {
+            if (data.size() - offset < static_cast<size_t>(length)) return false;
+            value.assign(data.data() + offset, static_cast<size_t>(length) - 1);
+            offset += static_cast<size_t>(length);
+            return true;
+        }
+
+        size_t units = static_cast<size_t>(-static_cast<int64_t>(length));
+        if ((data.size() - offset) / 2 < units) return false;
+        const char* text = data.data() + offset;
+        for (size_t i = 0; i + 1 < units; ++i) {
+            uint16_t unit = 0;
+            std::memcpy(&unit, text + 2 * i, 2);
+            uint32_t code_point = unit;
+            if (unit >= 0xD800 && unit < 0xDC00 && i + 2 < units) {
+                uint16_t low = 0;
+                std::memcpy(&low, text + 2 * (i + 1), 2);
+                if (low >= 0xDC00 && low < 0xE000) {
+                    code_point = 0x10000 + ((unit - 0xD800u) << 10) + (low - 0xDC00u);
+                    ++i;
+                }
+            }
+            append_utf8(value, code_point);
+        }
+        offset += units * 2;
+        return true;
+    }
+};
+
+// Entry as serialized in legacy indices and in the non-encodable list
+bool read_legacy_entry(Reader& reader, int32_t version, uint32_t& method, PakFile::Entry& entry) {
+    uint64_t offset = 0;
+    uint64_t size = 0;
+    uint64_t uncompressed_size = 0;
+    if (!reader.scalar(offset) || !reader.scalar(size) || !reader.scalar(uncompressed_size) ||
+        !reader.scalar(method)) {
+        return false;
+    }
+    if (version < version_no_timestamps && !reader.skip(8)) {
+        return false;
+    }
+    if (!reader.skip(hash_size)) {
+        return false;
+    }
+
+    entry.offset = offset;
+    entry.size = size;
+    entry.uncompressed_size = uncompressed_size;
+    entry.blocks.clear();
+
+    if (version >= version_compression_encryption) {
+        if (method != 0) {
+            int32_t count = 0;
+            if (!reader.scalar(count) || count < 0 ||
+                (reader.data.size() - reader.offset) / 16 < static_cast<size_t>(count)) {
+                return false;
+            }
+            // Block offsets are relative to the entry since version 5
+            uint64_t base = version >= version_relative_chunk_offsets ? offset : 0;
+            entry.blocks.resize(static_cast<size_t>(count));
+            for (auto& block : entry.blocks) {
+                reader.scalar(block.start);
+                reader.scalar(block.end);
+                block.start += base;
+                block.end += base;
+            }
+        }
+
+        uint8_t flags = 0;
+        if (!reader.scalar(flags) || !reader.scalar(entry.block_size)) {
+            return false;
+        }
+        entry.encrypted = (flags & 0x01) != 0;
+    }
+    return true;
+}
+
+// Bit-packed entry of path-hash indices (version 10+)
+bool decode_entry(std::string_view encoded, size_t at, int32_t version, uint32_t& method, PakFile::Entry& entry) {
+    if (at > encoded.size()) {
+        return false;
+    }
+    Reader reader{encoded, at};
+
+    uint32_t value = 0;
+    if (!reader.scalar(value)) {
+        return false;
+    }
+    method = (value >> 23) & 0x3F;
+    entry.encrypted = (value & (1u << 22)) != 0;
+    uint32_t block_count = (value >> 6) & 0xFFFF;
+    entry.block_size = (value & 0x3F) << 11;
+    if ((value & 0x3F) == 0x3F && !reader.scalar(entry.block_size)) {
+        return false;
+    }
+
+    // Each of the three sizes is stored in 32 bits when it fits
+    auto read_size = [&reader](bool fits_32, uint64_t& out) {
+        if (fits_32) {
+            uint32_t small = 0;
+            if (!reader.scalar(small)) return false;
+            out = small;
+            return true;
+        }
+        return reader.scalar(out);
+    };
+    if (!read_size((value & (1u << 31)) != 0, entry.offset) ||
+        !read_size((value & (1u << 30)) != 0, entry.uncompressed_size)) {
+        return false;
+    }
+    entry.size = entry.uncompressed_size;
+    if (method != 0 && !read_size((value & (1u << 29)) != 0, entry.size)) {
+        return false;
+    }
+
+    entry.blocks.clear();
+    uint64_t cursor = entry.offset + serialized_size(version, method != 0, block_count);
+    if (block_count == 1 && !entry.encrypted) {
+        entry.blocks.push_back({cursor, cursor + entry.size});
+    } else {
+        for (uint32_t i = 0; i < block_count; ++i) {
+            uint32_t block_size = 0;
+            if (!reader.scalar(block_size)) {
+                return false;
+            }
+            entry.blocks.push_back({cursor, cursor + block_size});
+            cursor += entry.encrypted ? (block_size + 15) & ~uint64_t{15} : block_size;
+        }
+    }
+    return true;
+}
+
+// "../../../Game/" mounts the project root: names are reported from there
+std::string project_relative_mount(std::string mount) {
+    std::replace(mount.begin(), mount.end(), '\\', '/');
+    bool climbed = false;
+    while (mount.rfind("../", 0) == 0) {
+        mount.erase(0, 3);
+        climbed = true;
+    }
+    if (climbed) {
+        size_t slash = mount.find('/');
+        mount.erase(0, slash == std::string::npos ? mount.size() : slash + 1);
+    }
+    while (!mount.empty() && mount.front() == '/') {
+        mount.erase(0, 1);
+    }
+    if (!mount.empty() && mount.back() != '/') {
+        mount.push_back('/');
+    }
+    return mount;
+}
+
+} // namespace
+
+bool PakFile::open(const std::filesystem::path& path) {
+    entries_.clear();
+    compression_methods_.clear();
+    error_.clear();
+
+    if (!file_.open(path)) {
+        error_ = "cannot open";
+        return false;
+    }
+    std::string_view data = file_.content();
+
+    // The footer's size depends on the version: find its magic near the end
+    size_t footer = std::string_view::npos;
+    uint64_t index_offset = 0;
+    uint64_t index_size = 0;
+    if (data.size() >= footer_size) {
+        size_t lowest = data.size() > footer_scan_bytes ? data.size() - footer_scan_bytes : 0;
+        for (size_t pos = data.size() - footer_size + 1; pos-- > lowest;) {
+            uint32_t magic = 0;
+            std::memcpy(&magic, data.data() + pos, sizeof(magic));
+            if (magic != pak_magic) {
+                continue;
+            }
+
+            Reader reader{data, pos + 4};
+            int32_t version = 0;
+            reader.scalar(version);
+            reader.scalar(index_offset);
+            reader.scalar(index_size);
+            if (version >= 1 && version <= version_latest && index_size > 0 &&
+                index_offset <= data.size() && data.size() - index_offset >= index_size) {
+                version_ = version;
+                footer = pos;
+                break;
+            }
+        }
+    }
+    if (footer == std::string_view::npos) {
+        error_ = "not a .pak file (no footer)";
+        return false;
+    }
+
+    if (version_ >= version_index_encryption && footer > 0 && data[footer - 1] != 0) {
+        error_ = "encrypted index";
+        return false;
+    }
+
+    size_t names = footer + footer_size;
+    if (version_ == version_frozen_index) {
+        if (names < data.size() && data[names] != 0) {
+            error_ = "frozen index";
+            return false;
+        }
+        ++names;
+    }
+    if (version_ >= version_fname_compression) {
+        for (; names + compression_name_length <= data.size(); names += compression_name_length) {
+            std::string_view name = data.substr(names, compression_name_length);
+            compression_methods_.emplace_back(name.substr(0, name.find('\0')));
+        }
+    }
+
+    if (!parse_index(data.substr(index_offset, index_size))) {
+        entries_.clear();
+        if (error_.empty()) {
+            error_ = "corrupt index";
+        }
+        return false;
+    }
+    return true;
+}
+
+PakFile::Compression PakFile::compression_of(uint32_t method) const {
+    if (method == 0) {
+        return Compression::Stored;
+    }
+    if (version_ < version_fname_compression) {
+        // Legacy flags: low bits are the method, the rest are speed/size biases
+        return (method & 0x0F) == 1 ? Compression::Zlib : Compression::Unsupported;
+    }
+    if (method > compression_methods_.size()) {
+        return Compression::Unsupported;
+    }
+    std::string name = compression_methods_[method - 1];
+    std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+    return name == "zlib" ? Compression::Zlib : Compression::Unsupported;
+}
+
+bool PakFile::parse_index(std::string_view index) {
+    Reader reader{index};
+    std::string mount;
+    int32_t entry_count = 0;
+    if (!reader.string(mount) || !reader.scalar(entry_count) || entry_count < 0) {
+        return false;
+    }
+    mount = project_relative_mount(mount);
+    entries_.reserve(std::min<size_t>(static_cast<size_t>(entry_count), index.size() / 16));
+
+    if (version_ < version_path_hash_index) {
+        for (int32_t i = 0; i < entry_count; ++i) {
+            Entry entry;
+            uint32_t method = 0;
+            if (!reader.string(entry.name) || !read_legacy_entry(reader, version_, method, entry)) {
+                return false;
+            }
+            entry.name = mount + entry.name;
+            entry.compression = compression_of(method);
+            entries_.push_back(std::move(entry));
+        }
+        return true;
+    }
+
+    // Path-hash index: names only live in the full directory index
+    uint64_t path_hash_seed = 0;
+    uint32_t has_path_hash_index = 0;
+    uint32_t has_directory_index = 0;
+    uint64_t directory_offset = 0;
+    uint64_t directory_size = 0;
+    if (!reader.scalar(path_hash_seed) || !reader.scalar(has_path_hash_index)) {
+        return false;
+    }
+    if (has_path_hash_index != 0 && !reader.skip(8 + 8 + hash_size)) {
+        return false;
+    }
+    if (!reader.scalar(has_directory_index)) {
+        return false;
+    }
+    if (has_directory_index != 0 &&
+        (!reader.scalar(directory_offset) || !reader.scalar(directory_size) || !reader.skip(hash_size))) {
+        return false;
+    }
+
+    int32_t encoded_size = 0;
+    if (!reader.scalar(encoded_size) || encoded_size < 0 || index.size() - reader.offset < static_cast<size_t>(encoded_size)) {
+        return false;
+    }
+    std::string_view encoded = index.substr(reader.offset, static_cast<size_t>(encoded_size));
+    reader.skip(static_cast<size_t>(encoded_size));
+
+    int32_t unencodable_count = 0;
+    if (!reader.scalar(unencodable_count) || unencodable_count < 0) {
+        return false;
+    }
+    std::vector<std::pair<Entry, uint32_t>> unencodable;
+    for (int32_t i = 0; i < unencodable_count; ++i) {
+        Entry entry;
+        uint32_t method = 0;
+        if (!read_legacy_entry(reader, version_, method, entry)) {
+            return false;
+        }
+        unencodable.emplace_back(std::move(entry), method);
+    }
+
+    std::string_view data = file_.content();
+    if (has_directory_index == 0 || directory_offset > data.size() || data.size() - directory_offset < directory_size) {
+        error_ = "no directory index";
+        return false;
+    }
+
+    Reader directories{data.substr(directory_offset, directory_size)};
+    int32_t directory_count = 0;
+    if (!directories.scalar(directory_count) || directory_count < 0) {
+        return false;
+    }
+    for (int32_t d = 0; d < directory_count; ++d) {
+        std::string directory;
+        int32_t file_count = 0;
+        if (!directories.string(directory) || !directories.scalar(file_count) || file_count < 0) {
+            return false;
+        }
+        while (!directory.empty() && directory.front() == '/') {
+            directory.erase(0, 1);
+        }
+        if (!directory.empty() && directory.back() != '/') {
+            directory.push_back('/');
+        }
+
+        for (int32_t f = 0; f < file_count; ++f) {
+            std::string file_name;
+            int32_t location = 0;
+            if (!directories.string(file_name) || !directories.scalar(location)) {
+                return false;
+            }
+
+            // Non-negative locations are byte offsets into the encoded
+            // entries, negative ones index the unencodable list
+            Entry entry;
+            uint32_t method = 0;
+            if (location >= 0) {
+                if (!decode_entry(encoded, static_cast<size_t>(location), version_, method, entry)) {
+                    return false;
+                }
+            } else {
+                size_t slot = static_cast<size_t>(-(static_cast<int64_t>(location) + 1));
+                if (slot >= unencodable.size()) {
+                    return false;
+                }
+                entry = unencodable[slot].first;
+                method = unencodable[slot].second;
+            }
+            entry.name = mount + directory + file_name;
+            entry.compression = compression_of(method);
+            entries_.push_back(std::move(entry));
+        }
+    }
+    return true;
+}
+
+bool PakFile::read(const Entry& entry, std::string& buffer, std::string_view& content) const {
+    if (entry.encrypted) {
+        return false;
+    }
+
+    std::string_view data = file_.content();
+    if (entry.compression == Compression::Stored) {
+        uint64_t start = entry.offset + serialized_size(version_, false, 0);
+        if (start > data.size() || data.size() - start < entry.size) {
+            return false;
+        }
+        content = data.substr(start, entry.size);
+        return true;
+    }
+
+    if (entry.compression != Compression::Zlib) {
+        return false;
+    }
+
+#ifdef SEARCHASSETS_HAS_ZLIB
+    // Corrupt sizes are rejected before allocating: deflate expands at most ~1032:1
+    uint64_t stored_bytes = 0;
+    for (const auto& block : entry.blocks) {
+        if (block.start > block.end || block.end > data.size()) {
+            return false;
+        }
+        stored_bytes += block.end - block.start;
+    }
+    if (entry.uncompressed_size > stored_bytes * 1032) {
+        return false;
+    }
+
+    // Each block is its own zlib stream, inflated straight into place
+    buffer.resize(entry.uncompressed_size);
+    z_stream stream{};
+    if (inflateInit(&stream) != Z_OK) {
+        return false;
+    }
+
+    size_t written = 0;
+    bool ok = true;
+    for (const auto& block : entry.blocks) {
+        if (written >= buffer.size() || block.end - block.start > UINT32_MAX) {
+            ok = false;
+            break;
+        }
+        size_t expected = buffer.size() - written;
+        if (entry.block_size > 0) {
+            expected = std::min<size_t>(expected, entry.block_size);
+        }
+
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data() + block.start));
+        stream.avail_in = static_cast<uInt>(block.end - block.start);
+        stream.next_out = reinterpret_cast<Bytef*>(buffer.data() + written);
+        stream.avail_out = static_cast<uInt>(expected);
+        if (inflate(&stream, Z_FINISH) != Z_STREAM_END) {
+            ok = false;
+            break;
+        }
+        written += expected - stream.avail_out;
+        inflateReset(&stream);
+    }
+    inflateEnd(&stream);
+
+    if (!ok || written != buffer.size()) {
+        return false;
+    }
+    content = std::string_view(buffer.data(), written);
+    return true;
+#else
+    (void)buffer;
+    return false;
+#endif
+}
+
+bool PakFile::zlib_available() {
+#ifdef SEARCHASSETS_HAS_ZLIB
+    return true;
+#else
+    return false;
+#endif
+}
+
+std::filesystem::path PakFile::virtual_path(const std::filesystem::path& container, const Entry& entry) {
+    return std::filesystem::path(container.string() + std::string(entry_separator) + entry.name);
+}
+
+std::optional<std::filesystem::path> PakFile::container_of(const std::filesystem::path& path) {
+    std::string text = path.string();
+    for (size_t pos = text.find(entry_separator); pos != std::string::npos;
+         pos = text.find(entry_separator, pos + 1)) {
+        if (pos >= 4) {
+            std::string extension = text.substr(pos - 4, 4);
+            std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+            if (extension == ".pak") {
+                return std::filesystem::path(text.substr(0, pos));
+            }
+        }
+    }
+    return std::nullopt;
+}
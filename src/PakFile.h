@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "MappedFile.h"
+
+// Read-only view of an Unreal .pak container. The index is parsed once and
+// every entry is exposed as a virtual file: stored entries are slices of the
+// container's mapping, zlib entries are inflated block by block into a
+// caller-owned buffer that is reused from one entry to the next.
+//
+// Legacy indices (versions 1 to 9) and path-hash indices with a full
+// directory index (10 and 11) are read. Encrypted indices and entries, and
+// compression methods other than zlib, are reported or skipped.
+class PakFile
+{
+public:
+    enum class Compression : uint8_t
+    {
+        Stored,
+        Zlib,
+        Unsupported
+    };
+
+    struct Block
+    {
+        uint64_t start; // Absolute offsets in the container
+        uint64_t end;
+    };
+
+    struct Entry
+    {
+        std::string name; // Relative to the project root: Content/Maps/Level.umap
+        uint64_t offset = 0;
+        uint64_t size = 0; // Stored size
+        uint64_t uncompressed_size = 0;
+        Compression compression = Compression::Stored;
+        uint32_t block_size = 0; // Uncompressed bytes per block
+        bool encrypted = false;
+        std::vector<Block> blocks;
+    };
+
+    // Separates the container from the entry in reported paths: Game.pak!/Content/...
+    static constexpr std::string_view entry_separator = "!/";
+
+    bool open(const std::filesystem::path &path);
+
+    // Why open() failed
+    const std::string &error() const { return error_; }
+
+    const std::vector<Entry> &entries() const { return entries_; }
+
+    // False for entries that cannot be read here (encrypted, unknown
+    // compression, corrupt). `content` stays valid until the next read into
+    // `buffer` or until the container is closed.
+    bool read(const Entry &entry, std::string &buffer, std::string_view &content) const;
+
+    // Whether this build can inflate zlib entries
+    static bool zlib_available();
+
+    // Path reported for an entry
+    static std::filesystem::path virtual_path(const std::filesystem::path &container, const Entry &entry);
+
+    // Container of a path produced by virtual_path()
+    static std::optional<std::filesystem::path> container_of(const std::filesystem::path &path);
+
+private:
+    bool parse_index(std::string_view index);
+    Compression compression_of(uint32_t method) const;
+
+    MappedFile file_;
+    std::string error_;
+    int32_t version_ = 0;
+    std::vector<std::string> compression_methods_; // Footer names, for versions 8+
+    std::vector<Entry> entries_;
+};
@@ -0,0 +1,116 @@
+#include "Prefetcher.h"
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+
+#ifndef _WIN32
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+Prefetcher::Prefetcher(RangeAt range_at, size_t min_depth, size_t max_depth)
+    : range_at_(std::move(range_at)),
+      min_depth_(min_depth),
+      max_depth_(std::max(min_depth, max_depth)),
+      depth_(std::min(std::max<size_t>(min_depth, 8), std::max(min_depth, max_depth))),
+      hint_thread_([this]() { hint_loop(); }) {
+}
+
+Prefetcher::~Prefetcher() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        shutdown_ = true;
+    }
+    hint_cv_.notify_one();
+    hint_thread_.join();
+}
+
+void Prefetcher::advance(size_t index) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        // Entries the loaders have reached are no longer worth a hint
+        next_hint_ = std::max(next_hint_, index + 1);
+        wanted_until_ = std::max(wanted_until_, index + 1 + depth_);
+        if (next_hint_ >= wanted_until_) {
+            return;
+        }
+    }
+    hint_cv_.notify_one();
+}
+
+void Prefetcher::hint_loop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        hint_cv_.wait(lock, [this]() { return shutdown_ || next_hint_ < wanted_until_; });
+        if (shutdown_) {
+            return;
+        }
+
+        size_t index = next_hint_++;
+        lock.unlock();
+        Range range = range_at_(index);
+        if (range.path != nullptr && range.length > 0) {
+            hint(*range.path, range.length);
+        }
+        lock.lock();
+
+        if (range.path == nullptr) {
+            // Past the entries known so far: retried after the next advance()
+            if (next_hint_ == index + 1) {
+                next_hint_ = index;
+            }
+            wanted_until_ = std::min(wanted_until_, next_hint_);
+        }
+    }
+}
+
+void Prefetcher::record(std::chrono::nanoseconds latency) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    latency_sum_ += latency;
+    if (++samples_ < window_) {
+        return;
+    }
+
+    auto average = latency_sum_ / samples_;
+    samples_ = 0;
+    latency_sum_ = std::chrono::nanoseconds{0};
+
+    if (average > cold_latency_) {
+        depth_ = std::min(max_depth_, std::max<size_t>(4, depth_ * 2));
+    } else if (average < warm_latency_) {
+        depth_ = std::max(min_depth_, depth_ * 3 / 4);
+    }
+}
+
+size_t Prefetcher::depth() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return depth_;
+}
+
+bool Prefetcher::hint(const std::filesystem::path& path, uint64_t length) {
+#ifdef _WIN32
+    (void)path;
+    (void)length;
+    return false;
+#else
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        return false;
+    }
+
+    bool hinted = false;
+#if defined(POSIX_FADV_WILLNEED)
+    // Queues readahead for the range and returns without waiting
+    hinted = posix_fadvise(fd, 0, static_cast<off_t>(std::min<uint64_t>(length, INT64_MAX)), POSIX_FADV_WILLNEED) == 0;
+#elif defined(F_RDADVISE)
+    radvisory advice{};
+    advice.ra_offset = 0;
+    advice.ra_count = static_cast<int>(std::min<uint64_t>(length, INT32_MAX));
+    hinted = fcntl(fd, F_RDADVISE, &advice) != -1;
+#endif
+
+    ::close(fd);
+    return hinted;
+#endif
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+// Asks the kernel to start reading files the I/O stage will open soon, so
+// device reads overlap with the loading and matching of earlier files.
+//
+// Loaders call advance() with the index they are about to open; the entries
+// up to index + depth that were not hinted yet are hinted by the prefetcher's
+// own thread, so a slow open() (network drives) never delays a loader. Each
+// entry comes with the length, from the start of the file, worth reading
+// ahead. Entries that are not known yet (the walk has not found them) are
+// hinted after a later call. The depth follows measured load latency: loads that
+// still wait on the device double it, loads served from the page cache
+// shrink it (down to no hints at all on warm trees, where the extra open per
+// file is pure overhead).
+class Prefetcher
+{
+public:
+    struct Range
+    {
+        const std::filesystem::path *path; // nullptr: no such entry yet
+        uint64_t length;                   // 0: nothing worth hinting
+    };
+    using RangeAt = std::function<Range(size_t index)>;
+
+    Prefetcher(RangeAt range_at, size_t min_depth, size_t max_depth);
+    ~Prefetcher();
+
+    Prefetcher(const Prefetcher &) = delete;
+    Prefetcher &operator=(const Prefetcher &) = delete;
+
+    void advance(size_t index);
+
+    // Time one entry took to open and fault in
+    void record(std::chrono::nanoseconds latency);
+
+    size_t depth() const;
+
+    // WILLNEED hint for the first `length` bytes of a file; false where the
+    // platform has none
+    static bool hint(const std::filesystem::path &path, uint64_t length);
+
+private:
+    static constexpr size_t window_ = 32;                           // Loads per depth decision
+    static constexpr std::chrono::microseconds cold_latency_{1000}; // Still waiting on the device
+    static constexpr std::chrono::microseconds warm_latency_{200};  // Served from the page cache
+
+    void hint_loop();
+
+    RangeAt range_at_;
+    size_t min_depth_;
+    size_t max_depth_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable hint_cv_;
+    size_t depth_;
+    size_t next_hint_ = 0;    // Entries before it were hinted or already loading
+    size_t wanted_until_ = 0; // Hint up to here
+    bool shutdown_ = false;
+    size_t samples_ = 0;
+    std::chrono::nanoseconds latency_sum_{0};
+    std::thread hint_thread_; // Last: starts once everything above exists
+};
@@ -0,0 +1,357 @@
+#include "ReferenceGraph.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <numeric>
+#include <unordered_set>
+
+namespace {
+
+constexpr uint32_t graph_magic = 0x47524153; // "SARG"
+constexpr uint32_t graph_version = 2; // 1 keyed assets by short name
+constexpr uint32_t no_name = UINT32_MAX;
+
+// Appended to the graph file name while it is written
+constexpr const char* temp_suffix = ".tmp";
+
+// Shortest reference worth keeping: "/A/B"
+constexpr size_t min_reference_length = 4;
+
+// Lowercased, without the .Object and :Sub suffixes of the last segment
+std::string normalized_name(std::string_view path) {
+    size_t slash = path.find_last_of('/');
+    size_t suffix = path.find_first_of(".:", slash == std::string_view::npos ? 0 : slash);
+    std::string name(path.substr(0, suffix));
+    std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+    return name;
+}
+
+// Part of a normalized name after its last slash
+std::string_view short_name(std::string_view name) {
+    size_t slash = name.find_last_of('/');
+    return slash == std::string_view::npos ? name : name.substr(slash + 1);
+}
+
+inline bool is_path_char(unsigned char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+           c == '_' || c == '-' || c == '/' || c == '.' || c == ':';
+}
+
+void write_u32(std::ofstream& out, uint32_t value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void write_array(std::ofstream& out, const std::vector<uint32_t>& values) {
+    write_u32(out, static_cast<uint32_t>(values.size()));
+    out.write(reinterpret_cast<const char*>(values.data()),
+              static_cast<std::streamsize>(values.size() * sizeof(uint32_t)));
+}
+
+void write_strings(std::ofstream& out, const std::vector<std::string>& strings) {
+    write_u32(out, static_cast<uint32_t>(strings.size()));
+    for (const auto& s : strings) {
+        write_u32(out, static_cast<uint32_t>(s.size()));
+        out.write(s.data(), static_cast<std::streamsize>(s.size()));
+    }
+}
+
+// Bounds-checked reader over the loaded file
+struct Reader {
+    const std::string& data;
+    size_t offset = 0;
+
+    bool u32(uint32_t& value) {
+        if (data.size() - offset < sizeof(value)) return false;
+        std::memcpy(&value, data.data() + offset, sizeof(value));
+        offset += sizeof(value);
+        return true;
+    }
+
+    bool array(std::vector<uint32_t>& values) {
+        uint32_t count = 0;
+        if (!u32(count) || (data.size() - offset) / sizeof(uint32_t) < count) return false;
+        values.resize(count);
+        std::memcpy(values.data(), data.data() + offset, count * sizeof(uint32_t));
+        offset += count * sizeof(uint32_t);
+        return true;
+    }
+
+    bool strings(std::vector<std::string>& values) {
+        uint32_t count = 0;
+        if (!u32(count)) return false;
+        values.clear();
+        values.reserve(std::min<size_t>(count, data.size()));
+        for (uint32_t i = 0; i < count; ++i) {
+            uint32_t length = 0;
+            if (!u32(length) || data.size() - offset < length) return false;
+            values.emplace_back(data, offset, length);
+            offset += length;
+        }
+        return true;
+    }
+};
+
+} // namespace
+
+uint32_t ReferenceGraph::Builder::intern(std::string_view asset_name) {
+    auto [it, inserted] = name_ids_.emplace(std::string(asset_name), static_cast<uint32_t>(names_.size()));
+    if (inserted) {
+        names_.emplace_back(asset_name);
+    }
+    return it->second;
+}
+
+uint32_t ReferenceGraph::Builder::add_package(const std::filesystem::path& package_path) {
+    auto id = static_cast<uint32_t>(package_paths_.size());
+    package_paths_.push_back(package_path.generic_string());
+    package_names_.push_back(intern(package_name(package_path)));
+    return id;
+}
+
+void ReferenceGraph::Builder::add_reference(uint32_t package_id, std::string_view referenced_asset) {
+    uint32_t name_id = intern(normalized_name(referenced_asset));
+    // Packages name themselves in their own tables; that isn't a reference
+    if (name_id != package_names_[package_id]) {
+        edges_.emplace_back(name_id, package_id);
+    }
+}
+
+ReferenceGraph ReferenceGraph::Builder::build() {
+    ReferenceGraph graph;
+
+    // Sort names so lookups can binary search, and remap every id
+    std::vector<uint32_t> order(names_.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) { return names_[a] < names_[b]; });
+
+    std::vector<uint32_t> remap(names_.size());
+    graph.names_.reserve(names_.size());
+    for (uint32_t sorted = 0; sorted < order.size(); ++sorted) {
+        remap[order[sorted]] = sorted;
+        graph.names_.push_back(std::move(names_[order[sorted]]));
+    }
+
+    graph.package_paths_ = std::move(package_paths_);
+    graph.package_names_.reserve(package_names_.size());
+    for (uint32_t name : package_names_) {
+        graph.package_names_.push_back(remap[name]);
+    }
+
+    for (auto& edge : edges_) {
+        edge.first = remap[edge.first];
+    }
+    std::sort(edges_.begin(), edges_.end());
+    edges_.erase(std::unique(edges_.begin(), edges_.end()), edges_.end());
+
+    graph.offsets_.assign(graph.names_.size() + 1, 0);
+    graph.referencers_.reserve(edges_.size());
+    for (const auto& [name, package] : edges_) {
+        ++graph.offsets_[name + 1];
+        graph.referencers_.push_back(package);
+    }
+    std::partial_sum(graph.offsets_.begin(), graph.offsets_.end(), graph.offsets_.begin());
+    graph.index_aliases();
+
+    *this = Builder();
+    return graph;
+}
+
+std::vector<std::string> ReferenceGraph::extract_references(std::string_view content) {
+    std::vector<std::string> references;
+    std::unordered_set<std::string_view> seen;
+
+    size_t pos = content.find('/');
+    while (pos != std::string_view::npos) {
+        size_t end = pos + 1;
+        while (end < content.size() && is_path_char(static_cast<unsigned char>(content[end]))) {
+            ++end;
+        }
+
+        // Must start a token and look like /Root/Name; /Script/ paths are native classes
+        bool starts_token = pos == 0 || !is_path_char(static_cast<unsigned char>(content[pos - 1]));
+        std::string_view token = content.substr(pos, end - pos);
+        token = token.substr(0, token.find_first_of(".:"));
+
+        if (starts_token && token.size() >= min_reference_length &&
+            token.find('/', 1) != std::string_view::npos && token.back() != '/' &&
+            token.substr(0, 8) != "/Script/" && seen.insert(token).second) {
+            references.emplace_back(token);
+        }
+
+        pos = content.find('/', end);
+    }
+
+    return references;
+}
+
+std::string ReferenceGraph::package_name(const std::filesystem::path& package_file) {
+    std::vector<std::string> folders;
+    for (const auto& part : package_file.parent_path()) {
+        std::string folder = part.string();
+        std::transform(folder.begin(), folder.end(), folder.begin(), ::tolower);
+        folders.push_back(std::move(folder));
+    }
+
+    auto content = std::find(folders.rbegin(), folders.rend(), "content");
+    if (content == folders.rend()) {
+        return asset_name(package_file.filename().string());
+    }
+
+    // Content/ of the project is /Game; of a plugin, the plugin's name
+    size_t content_index = static_cast<size_t>(folders.rend() - content) - 1;
+    bool in_plugin = content_index > 0 &&
+                     std::find(folders.begin(), folders.begin() + content_index, "plugins") != folders.begin() + content_index;
+    std::string name = "/" + (in_plugin ? folders[content_index - 1] : std::string("game"));
+    for (size_t i = content_index + 1; i < folders.size(); ++i) {
+        name += "/" + folders[i];
+    }
+    return name + "/" + asset_name(package_file.filename().string());
+}
+
+std::string ReferenceGraph::asset_name(std::string_view path) {
+    size_t slash = path.find_last_of("/\\");
+    std::string_view name = slash == std::string_view::npos ? path : path.substr(slash + 1);
+    name = name.substr(0, name.find_first_of(".:"));
+
+    std::string lower(name);
+    std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+    return lower;
+}
+
+bool ReferenceGraph::is_graph_file(const std::filesystem::path& path) {
+    std::string name = path.filename().string();
+    return name == default_file_name || name == std::string(default_file_name) + temp_suffix;
+}
+
+bool ReferenceGraph::save(const std::filesystem::path& graph_file) const {
+    // Written to a temporary file first so readers never see a partial graph
+    std::filesystem::path temp_file = graph_file;
+    temp_file += temp_suffix;
+
+    {
+        std::ofstream out(temp_file, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            return false;
+        }
+
+        write_u32(out, graph_magic);
+        write_u32(out, graph_version);
+        write_strings(out, names_);
+        write_strings(out, package_paths_);
+        write_array(out, package_names_);
+        write_array(out, offsets_);
+        write_array(out, referencers_);
+        if (!out) {
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(temp_file, graph_file, ec);
+    return !ec;
+}
+
+bool ReferenceGraph::load(const std::filesystem::path& graph_file) {
+    std::ifstream in(graph_file, std::ios::binary);
+    if (!in) {
+        return false;
+    }
+    std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    ReferenceGraph graph;
+    Reader reader{data};
+    uint32_t magic = 0;
+    uint32_t version = 0;
+    if (!reader.u32(magic) || magic != graph_magic || !reader.u32(version) || version != graph_version ||
+        !reader.strings(graph.names_) || !reader.strings(graph.package_paths_) ||
+        !reader.array(graph.package_names_) || !reader.array(graph.offsets_) || !reader.array(graph.referencers_)) {
+        return false;
+    }
+
+    // Reject files whose ids point outside their tables
+    if (graph.offsets_.size() != graph.names_.size() + 1 || graph.offsets_.back() != graph.referencers_.size() ||
+        graph.package_names_.size() != graph.package_paths_.size() ||
+        std::any_of(graph.referencers_.begin(), graph.referencers_.end(),
+                    [&graph](uint32_t id) { return id >= graph.package_paths_.size(); }) ||
+        std::any_of(graph.package_names_.begin(), graph.package_names_.end(),
+                    [&graph](uint32_t id) { return id >= graph.names_.size(); }) ||
+        !std::is_sorted(graph.offsets_.begin(), graph.offsets_.end())) {
+        return false;
+    }
+
+    graph.index_aliases();
+    *this = std::move(graph);
+    return true;
+}
+
+void ReferenceGraph::index_aliases() {
+    aliases_.resize(names_.size());
+    std::iota(aliases_.begin(), aliases_.end(), 0);
+    std::stable_sort(aliases_.begin(), aliases_.end(), [this](uint32_t a, uint32_t b) {
+        return short_name(names_[a]) < short_name(names_[b]);
+    });
+}
+
+uint32_t ReferenceGraph::find_name(std::string_view name) const {
+    auto it = std::lower_bound(names_.begin(), names_.end(), name,
+                               [](const std::string& entry, std::string_view key) { return entry < key; });
+    if (it == names_.end() || *it != name) {
+        return no_name;
+    }
+    return static_cast<uint32_t>(it - names_.begin());
+}
+
+std::vector<ReferenceGraph::Referencer> ReferenceGraph::find_referencers(std::string_view asset, uint32_t max_depth) const {
+    std::vector<Referencer> result;
+    std::string key = normalized_name(asset);
+    std::vector<uint32_t> frontier;
+    if (key.find('/') != std::string::npos) {
+        uint32_t start = find_name(key);
+        if (start != no_name) {
+            frontier.push_back(start);
+        }
+    } else {
+        // A short name stands for every asset that has it
+        auto first = std::lower_bound(aliases_.begin(), aliases_.end(), key, [this](uint32_t id, const std::string& name) {
+            return short_name(names_[id]) < name;
+        });
+        auto last = std::upper_bound(first, aliases_.end(), key, [this](const std::string& name, uint32_t id) {
+            return name < short_name(names_[id]);
+        });
+        frontier.assign(first, last);
+    }
+    if (frontier.empty() || max_depth == 0) {
+        return result;
+    }
+
+    // Breadth first over packages: a package found at depth d makes its own
+    // path the next thing to look up at depth d + 1
+    std::vector<uint8_t> visited_packages(package_paths_.size(), 0);
+    std::vector<uint8_t> visited_names(names_.size(), 0);
+    for (uint32_t name : frontier) {
+        visited_names[name] = 1;
+    }
+
+    for (uint32_t depth = 1; depth <= max_depth && !frontier.empty(); ++depth) {
+        std::vector<uint32_t> next;
+        for (uint32_t name : frontier) {
+            for (uint32_t i = offsets_[name]; i < offsets_[name + 1]; ++i) {
+                uint32_t package = referencers_[i];
+                if (visited_packages[package]) {
+                    continue;
+                }
+                visited_packages[package] = 1;
+                result.push_back({package_paths_[package], depth});
+
+                uint32_t package_name = package_names_[package];
+                if (!visited_names[package_name]) {
+                    visited_names[package_name] = 1;
+                    next.push_back(package_name);
+                }
+            }
+        }
+        frontier.swap(next);
+    }
+
+    return result;
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Reverse-reference graph: for each asset name, the packages that reference
+// it. Stored in CSR form (an offsets array indexing one flat array of
+// package ids) both in memory and on disk, so a lookup is a binary search
+// plus a slice, with no file I/O after load().
+//
+// Assets are keyed by their lowercased package path ("/game/env/m_rock" for
+// /Game/Env/M_Rock.M_Rock), so same-named assets in different folders stay
+// apart. Each package also knows its own path, which is what makes
+// transitive queries possible. Short names ("m_rock") are only a lookup
+// alias and may resolve to several assets.
+class ReferenceGraph
+{
+public:
+    static constexpr const char *default_file_name = ".searchassets.refgraph";
+
+    // True for a graph file (by its default name) or the temporary file it
+    // is written through
+    static bool is_graph_file(const std::filesystem::path &path);
+
+    struct Referencer
+    {
+        std::string package_path;
+        uint32_t depth; // 1 = references the asset directly
+    };
+
+    // Collects references while packages are scanned, then freezes them into
+    // CSR arrays. Not thread safe.
+    class Builder
+    {
+    public:
+        // Returns the package id to pass to add_reference
+        uint32_t add_package(const std::filesystem::path &package_path);
+        void add_reference(uint32_t package_id, std::string_view referenced_asset);
+        ReferenceGraph build();
+
+        size_t package_count() const { return package_paths_.size(); }
+
+    private:
+        uint32_t intern(std::string_view asset_name);
+
+        std::vector<std::string> package_paths_;
+        std::vector<uint32_t> package_names_;
+        std::vector<std::string> names_;
+        std::vector<std::pair<uint32_t, uint32_t>> edges_; // (name id, package id)
+        std::unordered_map<std::string, uint32_t> name_ids_;
+    };
+
+    // Package paths and short asset names referenced from a package's bytes:
+    // every /Root/Path/Name string, stripped of its .Object and :Sub suffixes
+    static std::vector<std::string> extract_references(std::string_view content);
+
+    // Short, lowercased asset name of a package path or file name
+    static std::string asset_name(std::string_view path);
+
+    // Lowercased package path of a package file, as references spell it:
+    // <Project>/Content/Env/M_Rock.uasset is /game/env/m_rock, and content
+    // of a plugin (any folder under Plugins/) is mounted at /<plugin>/.
+    // Files outside a Content folder get their short name.
+    static std::string package_name(const std::filesystem::path &package_file);
+
+    bool save(const std::filesystem::path &graph_file) const;
+    bool load(const std::filesystem::path &graph_file);
+
+    bool empty() const { return names_.empty(); }
+    size_t asset_count() const { return names_.size(); }
+    size_t package_count() const { return package_paths_.size(); }
+    size_t reference_count() const { return referencers_.size(); }
+
+    // Packages referencing the asset, then the packages referencing those,
+    // up to max_depth levels. Each package is reported once, at its lowest
+    // depth. `asset` is a package path (/Game/Env/M_Rock) or a short name,
+    // which looks up every asset of that name.
+    std::vector<Referencer> find_referencers(std::string_view asset, uint32_t max_depth = 1) const;
+
+private:
+    // Index of a name in the sorted name table, or UINT32_MAX
+    uint32_t find_name(std::string_view name) const;
+    // Sorts name ids by short name, for alias lookups
+    void index_aliases();
+
+    std::vector<std::string> names_;         // Sorted package paths
+    std::vector<uint32_t> aliases_;          // Name ids sorted by short name, not stored
+    std::vector<std::string> package_paths_;
+    std::vector<uint32_t> package_names_;    // Package id -> name id of the package itself
+    std::vector<uint32_t> offsets_;          // Name id -> first referencer, names_.size() + 1 entries
+    std::vector<uint32_t> referencers_;      // Package ids
+};
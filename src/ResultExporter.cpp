@@ -0,0 +1,188 @@
+#include "ResultExporter.h"
+#include <algorithm>
+
+namespace {
+
+// Length of the valid UTF-8 sequence starting at `at`, 0 if invalid
+size_t utf8_sequence_length(std::string_view text, size_t at) {
+    auto lead = static_cast<unsigned char>(text[at]);
+    size_t length = lead < 0xC2 ? 0 : lead < 0xE0 ? 2 : lead < 0xF0 ? 3 : lead < 0xF5 ? 4 : 0;
+    if (length == 0 || text.size() - at < length) {
+        return 0;
+    }
+    for (size_t i = 1; i < length; ++i) {
+        if ((static_cast<unsigned char>(text[at + i]) & 0xC0) != 0x80) {
+            return 0;
+        }
+    }
+    return length;
+}
+
+} // namespace
+
+ResultExporter::ResultExporter(ExportFormat format, Sink sink)
+    : format_(format), sink_(std::move(sink)) {
+    buffer_.reserve(chunk_size + 1024);
+}
+
+bool ResultExporter::begin(size_t count) {
+    switch (format_) {
+    case ExportFormat::Text:
+        buffer_ += "Search Results (" + std::to_string(count) + " items):\n";
+        buffer_ += "====================================\n";
+        break;
+    case ExportFormat::Csv:
+        buffer_ += "path,line,offset,match,duplicate_of\n";
+        break;
+    case ExportFormat::Ndjson:
+        break;
+    }
+    return flush_if_full();
+}
+
+bool ResultExporter::add(const SearchResult& result) {
+    const std::string path = result.file_path.string();
+    const std::string duplicate_of = result.duplicate_of.string();
+    ++count_;
+
+    switch (format_) {
+    case ExportFormat::Text:
+        buffer_ += std::to_string(count_);
+        buffer_ += ". ";
+        buffer_ += path;
+        buffer_ += result.line_number > 0 ? ":" + std::to_string(result.line_number)
+                                          : "@" + std::to_string(result.byte_offset);
+        buffer_ += "  ";
+        buffer_.append(result.line_content);
+        if (!duplicate_of.empty()) {
+            buffer_ += "  (same as " + duplicate_of + ")";
+        }
+        break;
+    case ExportFormat::Csv:
+        append_csv(path);
+        buffer_ += ',' + std::to_string(result.line_number) + ',' + std::to_string(result.byte_offset) + ',';
+        append_csv(result.line_content);
+        buffer_ += ',';
+        append_csv(duplicate_of);
+        break;
+    case ExportFormat::Ndjson:
+        buffer_ += "{\"path\":";
+        append_json(path);
+        buffer_ += ",\"line\":" + std::to_string(result.line_number);
+        buffer_ += ",\"offset\":" + std::to_string(result.byte_offset);
+        buffer_ += ",\"match\":";
+        append_json(result.line_content);
+        if (!duplicate_of.empty()) {
+            buffer_ += ",\"duplicate_of\":";
+            append_json(duplicate_of);
+        }
+        buffer_ += '}';
+        break;
+    }
+    buffer_ += '\n';
+    return flush_if_full();
+}
+
+bool ResultExporter::add_line(std::string_view line) {
+    ++count_;
+
+    switch (format_) {
+    case ExportFormat::Text:
+        buffer_ += std::to_string(count_);
+        buffer_ += ". ";
+        buffer_.append(line);
+        break;
+    case ExportFormat::Csv:
+        append_csv(line);
+        break;
+    case ExportFormat::Ndjson:
+        buffer_ += "{\"result\":";
+        append_json(line);
+        buffer_ += '}';
+        break;
+    }
+    buffer_ += '\n';
+    return flush_if_full();
+}
+
+bool ResultExporter::finish() {
+    if (!failed_ && !buffer_.empty()) {
+        failed_ = !sink_(buffer_);
+    }
+    buffer_.clear();
+    return !failed_;
+}
+
+bool ResultExporter::flush_if_full() {
+    if (failed_) {
+        return false;
+    }
+    if (buffer_.size() >= chunk_size) {
+        failed_ = !sink_(buffer_);
+        buffer_.clear();
+    }
+    return !failed_;
+}
+
+void ResultExporter::append_csv(std::string_view field) {
+    if (field.find_first_of(",\"\r\n") == std::string_view::npos) {
+        buffer_.append(field);
+        return;
+    }
+    buffer_ += '"';
+    for (char c : field) {
+        if (c == '"') {
+            buffer_ += '"';
+        }
+        buffer_ += c;
+    }
+    buffer_ += '"';
+}
+
+void ResultExporter::append_json(std::string_view text) {
+    // Binary match context is not valid UTF-8: such bytes become U+FFFD
+    static const char hex[] = "0123456789abcdef";
+    buffer_ += '"';
+    for (size_t i = 0; i < text.size();) {
+        auto c = static_cast<unsigned char>(text[i]);
+        if (c >= 0x80) {
+            size_t length = utf8_sequence_length(text, i);
+            if (length == 0) {
+                buffer_ += "\\ufffd";
+                ++i;
+            } else {
+                buffer_.append(text.substr(i, length));
+                i += length;
+            }
+            continue;
+        }
+
+        if (c == '"' || c == '\\') {
+            buffer_ += '\\';
+            buffer_ += static_cast<char>(c);
+        } else if (c == '\n') {
+            buffer_ += "\\n";
+        } else if (c == '\r') {
+            buffer_ += "\\r";
+        } else if (c == '\t') {
+            buffer_ += "\\t";
+        } else if (c < 0x20 || c == 0x7F) {
+            buffer_ += "\\u00";
+            buffer_ += hex[c >> 4];
+            buffer_ += hex[c & 0x0F];
+        } else {
+            buffer_ += static_cast<char>(c);
+        }
+        ++i;
+    }
+    buffer_ += '"';
+}
+
+std::optional<ExportFormat> ResultExporter::format_for(const std::filesystem::path& file) {
+    std::string extension = file.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    if (extension == ".txt") return ExportFormat::Text;
+    if (extension == ".csv") return ExportFormat::Csv;
+    if (extension == ".ndjson" || extension == ".jsonl") return ExportFormat::Ndjson;
+    return std::nullopt;
+}
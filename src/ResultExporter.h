@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include "SearchEngine.h"
+
+enum class ExportFormat
+{
+    Text,
+    Csv,
+    Ndjson
+};
+
+// Streams results to a sink (file, pipe) in fixed-size chunks, so memory
+// stays constant however many results are exported. Records are written as
+// they are added; call finish() to flush the last chunk.
+class ResultExporter
+{
+public:
+    static constexpr size_t chunk_size = 64 * 1024;
+
+    // Receives each chunk; false stops the export
+    using Sink = std::function<bool(std::string_view chunk)>;
+
+    ResultExporter(ExportFormat format, Sink sink);
+
+    // Text: a title with the count. CSV: the column names. NDJSON: nothing.
+    bool begin(size_t count);
+
+    // path, line (0 in binary files), byte offset, match context, duplicate_of
+    bool add(const SearchResult &result);
+
+    // A result known only as its display line (one "result" column/field)
+    bool add_line(std::string_view line);
+
+    bool finish();
+
+    size_t count() const { return count_; }
+
+    // .txt, .csv, .ndjson/.jsonl
+    static std::optional<ExportFormat> format_for(const std::filesystem::path &file);
+
+private:
+    bool flush_if_full();
+    void append_csv(std::string_view field);
+    void append_json(std::string_view text);
+
+    ExportFormat format_;
+    Sink sink_;
+    std::string buffer_;
+    size_t count_ = 0;
+    bool failed_ = false;
+};
@@ -0,0 +1,291 @@
+#include "ScanKernels.h"
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define SCAN_KERNELS_AVX2 1
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SCAN_KERNELS_SSE2 1
+#endif
+
+namespace scan_kernels {
+
+namespace {
+
+inline bool is_ascii_letter(unsigned char c) {
+    unsigned char lower = c | 0x20;
+    return lower >= 'a' && lower <= 'z';
+}
+
+void append_utf16le(std::string& out, uint32_t unit) {
+    out.push_back(static_cast<char>(unit & 0xff));
+    out.push_back(static_cast<char>((unit >> 8) & 0xff));
+}
+
+} // namespace
+
+size_t count_newlines(const char* begin, const char* end) {
+    size_t count = 0;
+    const char* p = begin;
+
+#ifdef SCAN_KERNELS_AVX2
+    const __m256i newline32 = _mm256_set1_epi8('\n');
+    for (; end - p >= 32; p += 32) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        auto mask = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, newline32)));
+        count += std::popcount(mask);
+    }
+#endif
+
+#ifdef SCAN_KERNELS_SSE2
+    const __m128i newline16 = _mm_set1_epi8('\n');
+    for (; end - p >= 16; p += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        auto mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newline16)));
+        count += std::popcount(mask);
+    }
+#endif
+
+    count += static_cast<size_t>(std::count(p, end, '\n'));
+    return count;
+}
+
+std::string utf8_to_utf16le(std::string_view utf8) {
+    std::string out;
+    out.reserve(utf8.size() * 2);
+
+    size_t i = 0;
+    while (i < utf8.size()) {
+        auto lead = static_cast<unsigned char>(utf8[i]);
+        uint32_t code_point = 0xFFFD;
+        size_t length = 1;
+
+        if (lead < 0x80) {
+            code_point = lead;
+        } else if ((lead & 0xE0) == 0xC0) {
+            length = 2;
+            code_point = lead & 0x1F;
+        } else if ((lead & 0xF0) == 0xE0) {
+            length = 3;
+            code_point = lead & 0x0F;
+        } else if ((lead & 0xF8) == 0xF0) {
+            length = 4;
+            code_point = lead & 0x07;
+        }
+
+        if (length > 1) {
+            bool valid = i + length <= utf8.size();
+            for (size_t k = 1; valid && k < length; ++k) {
+                auto next = static_cast<unsigned char>(utf8[i + k]);
+                valid = (next & 0xC0) == 0x80;
+                code_point = (code_point << 6) | (next & 0x3F);
+            }
+            if (!valid) {
+                code_point = 0xFFFD;
+                length = 1;
+            }
+        }
+
+        if (code_point >= 0x10000) {
+            code_point -= 0x10000;
+            append_utf16le(out, 0xD800 + (code_point >> 10));
+            append_utf16le(out, 0xDC00 + (code_point & 0x3FF));
+        } else {
+            append_utf16le(out, code_point);
+        }
+        i += length;
+    }
+
+    return out;
+}
+
+MultiLiteralMatcher::MultiLiteralMatcher(const std::vector<std::string>& needles, bool ignore_case, bool whole_word)
+    : ignore_case_(ignore_case), whole_word_(whole_word) {
+    for (const auto& needle : needles) {
+        std::string fold_mask(needle.size(), '\0');
+        for (size_t i = 0; i < needle.size(); ++i) {
+            if (ignore_case_ && is_ascii_letter(static_cast<unsigned char>(needle[i]))) {
+                fold_mask[i] = 0x20;
+            }
+        }
+        add_needle(needle, std::move(fold_mask), 1);
+    }
+    select_kernel();
+}
+
+void MultiLiteralMatcher::add_utf16le(std::string_view utf8) {
+    std::string bytes = utf8_to_utf16le(utf8);
+    std::string fold_mask(bytes.size(), '\0');
+    for (size_t i = 0; i + 1 < bytes.size(); i += 2) {
+        if (ignore_case_ && bytes[i + 1] == 0 && is_ascii_letter(static_cast<unsigned char>(bytes[i]))) {
+            fold_mask[i] = 0x20;
+        }
+    }
+    add_needle(std::move(bytes), std::move(fold_mask), 2);
+    select_kernel();
+}
+
+void MultiLiteralMatcher::add_needle(std::string bytes, std::string fold_mask, size_t unit) {
+    if (bytes.empty()) {
+        return;
+    }
+
+    for (size_t i = 0; i < bytes.size(); ++i) {
+        bytes[i] = static_cast<char>(bytes[i] | fold_mask[i]);
+    }
+
+    auto register_first = [this](unsigned char c) {
+        if (!first_byte_[c]) {
+            first_byte_[c] = true;
+            first_bytes_.push_back(c);
+        }
+    };
+    auto first = static_cast<unsigned char>(bytes[0]);
+    register_first(first);
+    if (fold_mask[0] != 0) {
+        register_first(static_cast<unsigned char>(first & ~0x20));
+    }
+
+    min_length_ = needles_.empty() ? bytes.size() : std::min(min_length_, bytes.size());
+    needles_.push_back({std::move(bytes), std::move(fold_mask), unit});
+}
+
+void MultiLiteralMatcher::select_kernel() {
+    if (ignore_case_) {
+        kernel_ = whole_word_ ? &MultiLiteralMatcher::find_kernel<true, true>
+                              : &MultiLiteralMatcher::find_kernel<true, false>;
+    } else {
+        kernel_ = whole_word_ ? &MultiLiteralMatcher::find_kernel<false, true>
+                              : &MultiLiteralMatcher::find_kernel<false, false>;
+    }
+}
+
+template <bool IgnoreCase>
+bool MultiLiteralMatcher::verify(const Needle& needle, const char* at) {
+    if constexpr (!IgnoreCase) {
+        return std::memcmp(at, needle.bytes.data(), needle.bytes.size()) == 0;
+    } else {
+        for (size_t i = 0; i < needle.bytes.size(); ++i) {
+            if ((at[i] | needle.fold_mask[i]) != needle.bytes[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+bool MultiLiteralMatcher::at_word_boundary(const Needle& needle, std::string_view haystack, size_t pos) {
+    // Only ends holding a word character need a non-word neighbour
+    auto is_word = [](unsigned char c) {
+        return is_ascii_letter(c) || (c >= '0' && c <= '9') || c == '_';
+    };
+    const auto* data = reinterpret_cast<const unsigned char*>(haystack.data());
+    const size_t end = pos + needle.bytes.size();
+    const size_t unit = needle.unit;
+
+    // A UTF-16 neighbour is a word character only if its high byte is zero
+    auto word_unit_at = [&](size_t at) {
+        return is_word(data[at]) && (unit == 1 || data[at + 1] == 0);
+    };
+
+    if (word_unit_at(pos) && pos >= unit && word_unit_at(pos - unit)) {
+        return false;
+    }
+    if (word_unit_at(end - unit) && end + unit <= haystack.size() && word_unit_at(end)) {
+        return false;
+    }
+    return true;
+}
+
+template <bool IgnoreCase, bool WholeWord>
+bool MultiLiteralMatcher::find_kernel(std::string_view haystack, size_t from,
+                                      size_t& match_pos, size_t& match_len) const {
+    if (needles_.empty() || haystack.size() < min_length_ || from > haystack.size() - min_length_) {
+        return false;
+    }
+
+    const char* data = haystack.data();
+    const size_t size = haystack.size();
+    const size_t last = size - min_length_;
+
+    // Needles are tried in order at each candidate, so the leftmost hit wins
+    auto try_at = [&](size_t pos) {
+        for (const auto& needle : needles_) {
+            if (needle.bytes.size() <= size - pos && verify<IgnoreCase>(needle, data + pos) &&
+                (!WholeWord || at_word_boundary(needle, haystack, pos))) {
+                match_pos = pos;
+                match_len = needle.bytes.size();
+                return true;
+            }
+        }
+        return false;
+    };
+
+    size_t pos = from;
+
+#ifdef SCAN_KERNELS_SSE2
+    if (needles_.size() == 1 && needles_[0].bytes.size() >= 2) {
+        // One needle: a candidate must match both its first and last byte
+        const Needle& needle = needles_[0];
+        const size_t last_offset = needle.bytes.size() - 1;
+        const __m128i first = _mm_set1_epi8(needle.bytes[0]);
+        const __m128i final = _mm_set1_epi8(needle.bytes[last_offset]);
+        const __m128i first_fold = _mm_set1_epi8(needle.fold_mask[0]);
+        const __m128i final_fold = _mm_set1_epi8(needle.fold_mask[last_offset]);
+
+        for (; size - pos >= last_offset + 16; pos += 16) {
+            __m128i head = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+            __m128i tail = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos + last_offset));
+            if constexpr (IgnoreCase) {
+                head = _mm_or_si128(head, first_fold);
+                tail = _mm_or_si128(tail, final_fold);
+            }
+
+            auto mask = static_cast<unsigned>(_mm_movemask_epi8(
+                _mm_and_si128(_mm_cmpeq_epi8(head, first), _mm_cmpeq_epi8(tail, final))));
+            while (mask != 0) {
+                if (try_at(pos + static_cast<size_t>(std::countr_zero(mask)))) {
+                    return true;
+                }
+                mask &= mask - 1;
+            }
+        }
+    } else if (first_bytes_.size() <= 4) {
+        __m128i probes[4];
+        for (size_t k = 0; k < first_bytes_.size(); ++k) {
+            probes[k] = _mm_set1_epi8(static_cast<char>(first_bytes_[k]));
+        }
+
+        for (; size - pos >= 16 && pos <= last; pos += 16) {
+            __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+            __m128i hits = _mm_cmpeq_epi8(chunk, probes[0]);
+            for (size_t k = 1; k < first_bytes_.size(); ++k) {
+                hits = _mm_or_si128(hits, _mm_cmpeq_epi8(chunk, probes[k]));
+            }
+
+            auto mask = static_cast<unsigned>(_mm_movemask_epi8(hits));
+            while (mask != 0) {
+                if (try_at(pos + static_cast<size_t>(std::countr_zero(mask)))) {
+                    return true;
+                }
+                mask &= mask - 1;
+            }
+        }
+    }
+#endif
+
+    for (; pos <= last; ++pos) {
+        if (first_byte_[static_cast<unsigned char>(data[pos])] && try_at(pos)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace scan_kernels
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Low-level byte scanning helpers shared by the search modes.
+// Each kernel uses SSE2/AVX2 when the target supports it and falls back
+// to a scalar loop for the tail and on other architectures.
+namespace scan_kernels
+{
+    // Number of '\n' bytes in [begin, end)
+    size_t count_newlines(const char *begin, const char *end);
+
+    // Re-encodes UTF-8 text as UTF-16LE bytes (invalid sequences become U+FFFD)
+    std::string utf8_to_utf16le(std::string_view utf8);
+
+    // Finds the leftmost occurrence of any of a few literal needles in a
+    // single pass, without copying or converting the haystack. Candidates
+    // come from a SIMD scan (first and last byte for a single needle, the
+    // set of first bytes otherwise) and are verified in place.
+    //
+    // Case folding and whole-word checks are template parameters of the
+    // kernel, which is picked once when the matcher is built, so the inner
+    // loops never branch on the mode. Folding covers ASCII letters only, at
+    // the positions where the needle holds one.
+    class MultiLiteralMatcher
+    {
+    public:
+        MultiLiteralMatcher() = default;
+        MultiLiteralMatcher(const std::vector<std::string> &needles, bool ignore_case, bool whole_word = false);
+
+        // Adds the UTF-16LE form of a UTF-8 needle, folding only code units
+        // whose high byte is zero
+        void add_utf16le(std::string_view utf8);
+
+        bool empty() const { return needles_.empty(); }
+
+        bool find(std::string_view haystack, size_t from, size_t &match_pos, size_t &match_len) const
+        {
+            return (this->*kernel_)(haystack, from, match_pos, match_len);
+        }
+
+    private:
+        struct Needle
+        {
+            std::string bytes;     // Lowercased at folded positions
+            std::string fold_mask; // 0x20 at folded positions: (byte | mask) == needle byte
+            size_t unit;           // 1 for UTF-8, 2 for UTF-16LE (word boundaries)
+        };
+
+        using Kernel = bool (MultiLiteralMatcher::*)(std::string_view, size_t, size_t &, size_t &) const;
+
+        template <bool IgnoreCase, bool WholeWord>
+        bool find_kernel(std::string_view haystack, size_t from, size_t &match_pos, size_t &match_len) const;
+
+        template <bool IgnoreCase>
+        static bool verify(const Needle &needle, const char *at);
+
+        static bool at_word_boundary(const Needle &needle, std::string_view haystack, size_t pos);
+
+        void add_needle(std::string bytes, std::string fold_mask, size_t unit);
+        void select_kernel();
+
+        std::vector<Needle> needles_;
+        bool ignore_case_ = false;
+        bool whole_word_ = false;
+        size_t min_length_ = 0;
+        std::array<bool, 256> first_byte_{};
+        std::vector<unsigned char> first_bytes_; // Distinct first bytes, SIMD scanned when few
+        Kernel kernel_ = &MultiLiteralMatcher::find_kernel<false, false>;
+    };
+}
@@ -0,0 +1,275 @@
+#include "ScanPipeline.h"
+#include <algorithm>
+#include <future>
+#include <vector>
+
+namespace {
+
+StageLimits normalized(StageLimits limits) {
+    limits.min_workers = std::max<size_t>(1, limits.min_workers);
+    limits.max_workers = std::max(limits.min_workers, limits.max_workers);
+    return limits;
+}
+
+} // namespace
+
+ScanPipeline::ScanPipeline(StageLimits io, StageLimits match, size_t queue_capacity)
+    : queue_capacity_(std::max<size_t>(1, queue_capacity)) {
+    io_.limits = normalized(io);
+    match_.limits = normalized(match);
+}
+
+ScanPipeline::Stats ScanPipeline::run(const NextFn& next, const LoadFn& load, const MatchFn& match,
+                                      const std::atomic<bool>& stop, size_t max_items) {
+    if (max_items == 0) {
+        return {};
+    }
+
+    // Start with few I/O workers (a warm cache needs no more) and half the
+    // match workers; the ticks below grow whichever stage is the bottleneck
+    for (Stage* stage : {&io_, &match_}) {
+        stage->bytes = 0;
+        stage->last_bytes = 0;
+        stage->last_rate = 0.0;
+        stage->last_step = 0;
+        stage->hold_ticks = 0;
+    }
+    io_.target = io_.limits.min_workers;
+    match_.target = std::max(match_.limits.min_workers, match_.limits.max_workers / 2);
+    io_.peak = io_.target;
+    match_.peak = match_.target;
+
+    const size_t io_threads = std::min(io_.limits.max_workers, max_items);
+    const size_t match_threads = std::min(match_.limits.max_workers, max_items);
+    source_done_ = false;
+    queue_.clear();
+    io_running_ = 0;
+    match_running_ = 0;
+    io_done_ = false;
+
+    // Threads are started as the targets grow and then kept until the run
+    // ends, so a short run (a keystroke narrowing a few files) starts only
+    // the initial few instead of every stage's maximum
+    std::vector<std::future<void>> workers;
+    size_t io_started = 0;
+    size_t match_started = 0;
+    auto start_workers = [&]() {
+        size_t io_from = io_started;
+        size_t match_from = match_started;
+        {
+            // Counted before the threads exist, so a stage cannot look finished
+            // while one of its workers is still starting
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!io_done_ && !source_done_) {
+                io_started = std::max(io_started, std::min<size_t>(io_.target, io_threads));
+                io_running_ += io_started - io_from;
+            }
+            if (match_started == 0 || match_running_ > 0) {
+                match_started = std::max(match_started, std::min<size_t>(match_.target, match_threads));
+                match_running_ += match_started - match_from;
+            }
+        }
+        for (size_t slot = io_from; slot < io_started; ++slot) {
+            workers.emplace_back(std::async(std::launch::async, [this, slot, &next, &load, &stop]() {
+                io_worker(slot, next, load, stop);
+            }));
+        }
+        for (size_t slot = match_from; slot < match_started; ++slot) {
+            workers.emplace_back(std::async(std::launch::async, [this, slot, &match, &stop]() {
+                match_worker(slot, match, stop);
+            }));
+        }
+    };
+    start_workers();
+
+    auto last_tick = std::chrono::steady_clock::now();
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (done_cv_.wait_for(lock, tick_, [this]() { return match_running_ == 0; })) {
+                break;
+            }
+        }
+
+        if (stop) {
+            // Waiting workers only re-check the flag when woken
+            io_cv_.notify_all();
+            match_cv_.notify_all();
+            park_cv_.notify_all();
+            continue;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        tune(std::chrono::duration<double>(now - last_tick).count());
+        last_tick = now;
+        start_workers();
+    }
+
+    // Matchers that saw `stop` may all be gone before the tick above woke the
+    // I/O workers blocked on a full queue. Taking the mutex first means every
+    // waiter has either seen the flag or is asleep and gets this wakeup.
+    { std::lock_guard<std::mutex> lock(mutex_); }
+    io_cv_.notify_all();
+    park_cv_.notify_all();
+
+    for (auto& worker : workers) {
+        worker.wait();
+    }
+    queue_.clear();
+
+    Stats stats;
+    stats.io_workers = io_.target;
+    stats.match_workers = match_.target;
+    stats.peak_io_workers = io_.peak;
+    stats.peak_match_workers = match_.peak;
+    return stats;
+}
+
+void ScanPipeline::io_worker(size_t slot, const NextFn& next, const LoadFn& load, const std::atomic<bool>& stop) {
+    while (!stop) {
+        if (slot >= io_.target) {
+            std::unique_lock<std::mutex> lock(mutex_);
+            park_cv_.wait(lock, [&]() { return slot < io_.target || stop || source_done_; });
+            if (source_done_) {
+                break;
+            }
+            continue;
+        }
+
+        size_t index = 0;
+        if (!next(index)) {
+            // Parked workers wait for items that will not come
+            std::lock_guard<std::mutex> lock(mutex_);
+            source_done_ = true;
+            park_cv_.notify_all();
+            break;
+        }
+
+        Loaded loaded;
+        loaded.index = index;
+        load(index, loaded.file);
+        io_.bytes.fetch_add(loaded.file.size(), std::memory_order_relaxed);
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        io_cv_.wait(lock, [&]() { return queue_.size() < queue_capacity_ || stop; });
+        if (stop) {
+            break;
+        }
+        queue_.push_back(std::move(loaded));
+        match_cv_.notify_one();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (--io_running_ == 0) {
+        io_done_ = true;
+        match_cv_.notify_all();
+    }
+    park_cv_.notify_all();
+}
+
+void ScanPipeline::match_worker(size_t slot, const MatchFn& match, const std::atomic<bool>& stop) {
+    while (true) {
+        Loaded loaded;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            auto finished = [&]() { return stop || (io_done_ && queue_.empty()); };
+            if (slot >= match_.target && !finished()) {
+                park_cv_.wait(lock, [&]() { return slot < match_.target || finished(); });
+                continue;
+            }
+
+            match_cv_.wait(lock, [&]() { return !queue_.empty() || finished(); });
+            if (stop || queue_.empty()) {
+                break;
+            }
+            loaded = std::move(queue_.front());
+            queue_.pop_front();
+            if (io_done_ && queue_.empty()) {
+                match_cv_.notify_all();
+                park_cv_.notify_all();
+            }
+        }
+        io_cv_.notify_one();
+
+        match(loaded.index, loaded.file);
+        match_.bytes.fetch_add(loaded.file.size(), std::memory_order_relaxed);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (--match_running_ == 0) {
+        done_cv_.notify_all();
+    }
+}
+
+void ScanPipeline::tune(double seconds) {
+    if (seconds <= 0.0) {
+        return;
+    }
+
+    size_t depth = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        depth = queue_.size();
+    }
+
+    auto rate_of = [seconds](Stage& stage) {
+        uint64_t bytes = stage.bytes.load(std::memory_order_relaxed);
+        double rate = static_cast<double>(bytes - stage.last_bytes) / seconds;
+        stage.last_bytes = bytes;
+        return rate;
+    };
+    double io_rate = rate_of(io_);
+    double match_rate = rate_of(match_);
+
+    {
+        // Targets are read by waiting workers under the same mutex
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (depth * 4 >= queue_capacity_ * 3) {
+            // Loaded files pile up: matching is the bottleneck
+            climb(match_, match_rate);
+            shrink(io_);
+        } else if (depth * 4 <= queue_capacity_ && !io_done_) {
+            // Matchers wait for data: the device is the bottleneck
+            climb(io_, io_rate);
+            shrink(match_);
+        }
+    }
+
+    park_cv_.notify_all();
+}
+
+void ScanPipeline::climb(Stage& stage, double rate) {
+    if (stage.hold_ticks > 0) {
+        --stage.hold_ticks;
+        return;
+    }
+
+    size_t target = stage.target;
+    if (stage.last_step > 0 && rate < stage.last_rate * 1.05) {
+        // The workers added last tick did not pay off: give one back and wait
+        if (target > stage.limits.min_workers) {
+            stage.target = target - 1;
+        }
+        stage.last_step = -1;
+        stage.hold_ticks = 10;
+    } else if (target < stage.limits.max_workers) {
+        stage.target = std::min(stage.limits.max_workers, target + std::max<size_t>(1, target / 4));
+        stage.last_step = 1;
+    } else {
+        stage.last_step = 0;
+    }
+
+    stage.last_rate = rate;
+    stage.peak = std::max(stage.peak, stage.target.load());
+}
+
+void ScanPipeline::shrink(Stage& stage) {
+    // Rates measured while another stage was limiting are not comparable
+    size_t target = stage.target;
+    if (target > stage.limits.min_workers) {
+        stage.target = target - 1;
+    }
+    stage.last_step = 0;
+    stage.last_rate = 0.0;
+    stage.hold_ticks = 0;
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include "MappedFile.h"
+
+// Worker count bounds for one pipeline stage
+struct StageLimits
+{
+    size_t min_workers = 1;
+    size_t max_workers = 1;
+};
+
+// Two-stage scan over files claimed one at a time from a source that may
+// still be growing (a directory walk in progress). I/O workers open, map and
+// fault in files (mostly blocked on the device); match workers run the
+// kernels over files that are already resident. A bounded queue sits
+// between them.
+//
+// Each stage runs up to `target` workers. Threads are started the first time
+// a target reaches them (never more than max_workers) and sleep while it is
+// lower again. Every tick the stage that limits throughput is found from the
+// queue depth (full: matching, empty: I/O) and its target is hill-climbed on
+// measured bytes/s, while a stage starving the other one is shrunk back so
+// cached runs do not oversubscribe the CPUs.
+class ScanPipeline
+{
+public:
+    // Claims the next item for an I/O worker. May block while the source can
+    // still grow; false once it is exhausted or `stop` is set.
+    using NextFn = std::function<bool(size_t &index)>;
+    // Opens and faults in item `index`. Items that fail to open are still
+    // handed to the match stage, with `file` closed.
+    using LoadFn = std::function<void(size_t index, MappedFile &file)>;
+    // Matches a loaded item; the mapping is released afterwards
+    using MatchFn = std::function<void(size_t index, const MappedFile &file)>;
+
+    struct Stats
+    {
+        size_t io_workers = 0;    // Targets when the run ended
+        size_t match_workers = 0;
+        size_t peak_io_workers = 0;
+        size_t peak_match_workers = 0;
+    };
+
+    ScanPipeline(StageLimits io, StageLimits match, size_t queue_capacity);
+
+    // Blocks until every item is matched or `stop` is set. `max_items` only
+    // bounds the threads started, for sources known to be small.
+    Stats run(const NextFn &next, const LoadFn &load, const MatchFn &match, const std::atomic<bool> &stop,
+              size_t max_items = SIZE_MAX);
+
+private:
+    static constexpr std::chrono::milliseconds tick_{50};
+
+    struct Loaded
+    {
+        size_t index = 0;
+        MappedFile file;
+    };
+
+    struct Stage
+    {
+        StageLimits limits;
+        std::atomic<size_t> target{1};
+        std::atomic<uint64_t> bytes{0}; // Completed since the run started
+        uint64_t last_bytes = 0;
+        double last_rate = 0.0;
+        int last_step = 0;  // +1 grew, -1 shrank, 0 held on the previous tick
+        int hold_ticks = 0; // Ticks to wait after a step that did not pay off
+        size_t peak = 0;
+    };
+
+    void io_worker(size_t slot, const NextFn &next, const LoadFn &load, const std::atomic<bool> &stop);
+    void match_worker(size_t slot, const MatchFn &match, const std::atomic<bool> &stop);
+    void tune(double seconds);
+    static void climb(Stage &stage, double rate);
+    static void shrink(Stage &stage);
+
+    Stage io_;
+    Stage match_;
+    size_t queue_capacity_;
+
+    std::mutex mutex_;
+    std::condition_variable io_cv_;    // Queue has room
+    std::condition_variable match_cv_; // Queue has items, or loading is done
+    std::condition_variable park_cv_;  // A target grew; parked workers never take queue wakeups
+    std::condition_variable done_cv_;
+    std::deque<Loaded> queue_;
+    bool source_done_ = false; // NextFn returned false
+    size_t io_running_ = 0;
+    size_t match_running_ = 0;
+    bool io_done_ = false;
+};
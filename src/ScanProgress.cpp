@@ -0,0 +1,75 @@
+#include "ScanProgress.h"
+
+void ScanProgress::start(const std::vector<std::filesystem::path>& roots) {
+    std::lock_guard<std::mutex> lock(sample_mutex_);
+    roots_.clear();
+    for (const auto& path : roots) {
+        roots_.push_back(std::make_unique<Root>());
+        roots_.back()->path = path;
+    }
+    if (roots_.empty()) {
+        roots_.push_back(std::make_unique<Root>());
+    }
+
+    last_time_ = std::chrono::steady_clock::now();
+    last_files_ = 0;
+    last_bytes_ = 0;
+    files_rate_ = 0.0;
+    bytes_rate_ = 0.0;
+    active_ = true;
+}
+
+void ScanProgress::finish() {
+    active_ = false;
+}
+
+ScanProgress::Sample ScanProgress::sample() {
+    std::lock_guard<std::mutex> lock(sample_mutex_);
+    Sample sample;
+    sample.active = active_;
+
+    sample.roots.reserve(roots_.size());
+    for (const auto& root : roots_) {
+        RootSample& out = sample.roots.emplace_back();
+        out.root = root->path;
+        out.files_done = root->files_done.load();
+        out.files_total = root->files_total.load();
+        out.bytes_done = root->bytes_done.load();
+        out.bytes_total = root->bytes_total.load();
+        out.hits = root->hits.load();
+
+        sample.files_done += out.files_done;
+        sample.files_total += out.files_total;
+        sample.bytes_done += out.bytes_done;
+        sample.bytes_total += out.bytes_total;
+        sample.hits += out.hits;
+    }
+
+    // Exponential average over windows, so one slow file does not make the
+    // numbers jump on every tick
+    auto now = std::chrono::steady_clock::now();
+    if (now - last_time_ >= rate_window_) {
+        double seconds = std::chrono::duration<double>(now - last_time_).count();
+        double files_rate = (sample.files_done - last_files_) / seconds;
+        double bytes_rate = (sample.bytes_done - last_bytes_) / seconds;
+        bool first = files_rate_ == 0.0 && bytes_rate_ == 0.0;
+        files_rate_ = first ? files_rate : 0.5 * files_rate_ + 0.5 * files_rate;
+        bytes_rate_ = first ? bytes_rate : 0.5 * bytes_rate_ + 0.5 * bytes_rate;
+        last_time_ = now;
+        last_files_ = sample.files_done;
+        last_bytes_ = sample.bytes_done;
+    }
+    sample.files_per_second = files_rate_;
+    sample.bytes_per_second = bytes_rate_;
+
+    // Bytes predict the remaining time better than file counts: sizes vary
+    // by orders of magnitude across a project
+    if (bytes_rate_ > 0.0 && sample.bytes_total > sample.bytes_done) {
+        sample.eta_seconds = (sample.bytes_total - sample.bytes_done) / bytes_rate_;
+    } else if (files_rate_ > 0.0 && sample.files_total > sample.files_done) {
+        sample.eta_seconds = (sample.files_total - sample.files_done) / files_rate_;
+    } else if (sample.files_total > 0 && sample.files_done >= sample.files_total) {
+        sample.eta_seconds = 0.0;
+    }
+    return sample;
+}
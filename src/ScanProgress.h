@@ -0,0 +1,95 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Live counters of a scan, kept per search root. Scan threads only add to
+// them with relaxed atomics (no locks, no allocation); the UI samples them
+// on its refresh tick and derives rates and the ETA there. Every counter
+// owns a cache line, so cores bumping different counters never share one.
+class ScanProgress
+{
+public:
+    struct RootSample
+    {
+        std::filesystem::path root;
+        uint64_t files_done = 0;
+        uint64_t files_total = 0;
+        uint64_t bytes_done = 0;
+        uint64_t bytes_total = 0;
+        uint64_t hits = 0;
+    };
+
+    struct Sample
+    {
+        bool active = false; // Between start() and finish()
+        uint64_t files_done = 0;
+        uint64_t files_total = 0;
+        uint64_t bytes_done = 0;
+        uint64_t bytes_total = 0;
+        uint64_t hits = 0;
+        double files_per_second = 0.0;
+        double bytes_per_second = 0.0;
+        double eta_seconds = -1.0; // Negative until a rate is known
+        std::vector<RootSample> roots;
+    };
+
+    // Called by the engine around a scan; the root list is fixed until the
+    // next start(), so scan threads index it without locking
+    void start(const std::vector<std::filesystem::path> &roots);
+    void finish();
+
+    // Totals grow as work is discovered (files listed, containers opened)
+    void add_total(size_t root, uint64_t files, uint64_t bytes)
+    {
+        roots_[root]->files_total.add(files);
+        roots_[root]->bytes_total.add(bytes);
+    }
+    void add_done(size_t root, uint64_t files, uint64_t bytes)
+    {
+        roots_[root]->files_done.add(files);
+        roots_[root]->bytes_done.add(bytes);
+    }
+    void add_hits(size_t root, uint64_t hits) { roots_[root]->hits.add(hits); }
+
+    // Rates are smoothed over samples at least rate_window_ apart
+    Sample sample();
+
+private:
+    struct alignas(64) Counter
+    {
+        std::atomic<uint64_t> value{0};
+
+        void add(uint64_t amount) { value.fetch_add(amount, std::memory_order_relaxed); }
+        uint64_t load() const { return value.load(std::memory_order_relaxed); }
+    };
+
+    struct Root
+    {
+        std::filesystem::path path;
+        Counter files_done;
+        Counter files_total;
+        Counter bytes_done;
+        Counter bytes_total;
+        Counter hits;
+    };
+
+    static constexpr std::chrono::milliseconds rate_window_{250};
+
+    std::vector<std::unique_ptr<Root>> roots_;
+    std::atomic<bool> active_{false};
+
+    // Sampler state, touched only by sample() and start()
+    std::mutex sample_mutex_;
+    std::chrono::steady_clock::time_point last_time_;
+    uint64_t last_files_ = 0;
+    uint64_t last_bytes_ = 0;
+    double files_rate_ = 0.0;
+    double bytes_rate_ = 0.0;
+};
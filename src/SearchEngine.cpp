@@ -1,4 +1,7 @@
 #include "SearchEngine.h"
+#include "MappedFile.h"
+#include "Prefetcher.h"
+#include <chrono>
 #include <thread>
 #include <fstream>
 #include <sstream>
@@ -6,20 +9,38 @@
 #include <numeric>
 #include <queue>
 
-#ifdef _WIN32
-#ifndef NOMINMAX
-#define NOMINMAX
-#endif
-#include <windows.h>
-#else
-#include <sys/mman.h>
-#include <sys/stat.h>
-#include <fcntl.h>
-#include <unistd.h>
-#endif
+namespace {
+
+bool is_separator(char c) {
+    return c == '/' || c == '\\';
+}
+
+// Folder steps between two directories: up from one to their common
+// ancestor, then down to the other
+size_t folder_distance(std::string_view from, std::string_view to) {
+    size_t common = 0;
+    size_t i = 0;
+    for (; i < from.size() && i < to.size() && from[i] == to[i]; ++i) {
+        if (is_separator(from[i])) {
+            common = i;
+        }
+    }
+    if ((i == from.size() || is_separator(from[i])) && (i == to.size() || is_separator(to[i]))) {
+        common = i;
+    }
+
+    size_t steps = 0;
+    for (char c : from.substr(common)) steps += is_separator(c);
+    for (char c : to.substr(common)) steps += is_separator(c);
+    return steps;
+}
+
+} // namespace
 
 SearchEngine::SearchEngine() : thread_count_(std::thread::hardware_concurrency()) {
     if (thread_count_ == 0) thread_count_ = 4;
+    match_limits_ = {1, thread_count_};
+    set_extension_filter({}, default_excluded_extensions());
 }
 
 SearchEngine::~SearchEngine() {
@@ -29,30 +50,36 @@ SearchEngine::~SearchEngine() {
 void SearchEngine::search(const std::string& search_pattern,
                          const std::vector<std::filesystem::path>& search_paths,
                          ProgressCallback progress_cb,
-                         ResultCallback result_cb) {
-    if (searching_) {
+                         ResultCallback result_cb,
+                         const std::atomic<bool>* cancel) {
+    if (searching_.exchange(true)) {
         return;
     }
 
-
-    searching_ = true;
+    // Reset before the token is read: a cancel set at any point after the
+    // caller decided to search stops it, through the token or stop_search()
     stop_requested_ = false;
+    if (cancel && *cancel) {
+        stop_requested_ = true;
+    }
+    last_search_completed_ = false;
+    result_limit_reached_ = false;
     clear_results();
 
-    try {
-        // Use case insensitive regex
-        compiled_pattern_ = std::regex(search_pattern, std::regex_constants::icase);
-        std::vector<std::future<void>> futures;
+    if (!stop_requested_ && compile_pattern(search_pattern, progress_cb)) {
+        progress_.start(search_paths);
 
-        for (const auto& path : search_paths) {
-            if (stop_requested_) break;
+        // Limited literal searches scan near the files named like the pattern first
+        ScanFeed feed(result_limit_ > 0 && is_literal_pattern(search_pattern) ? search_pattern : std::string());
+        std::mutex walk_mutex;
+        std::vector<ScanEntry> containers;
+        std::vector<ScanEntry> walked; // Ordered output sorts the whole walk first
 
+        std::vector<std::pair<uint32_t, std::filesystem::path>> roots;
+        for (size_t root = 0; root < search_paths.size(); ++root) {
+            const auto& path = search_paths[root];
             if (std::filesystem::exists(path)) {
-                futures.emplace_back(
-                    std::async(std::launch::async,
-                              &SearchEngine::search_directory_worker,
-                              this, path, progress_cb, result_cb)
-                );
+                roots.emplace_back(static_cast<uint32_t>(root), path);
             } else {
                 std::string error_msg = "Directory not found: " + path.string();
                 if (progress_cb) {
@@ -61,17 +88,325 @@ void SearchEngine::search(const std::string& search_pattern,
             }
         }
 
-        for (auto& future : futures) {
-            future.wait();
+        // Roots are walked in parallel and stream into the scan as files are
+        // found; the last walk to finish closes the feed
+        std::atomic<size_t> walks_running{roots.size()};
+        std::vector<std::future<void>> walks;
+        for (const auto& [root, path] : roots) {
+            walks.emplace_back(
+                std::async(std::launch::async, [&, root = root, path = path]() {
+                    if (progress_cb) {
+                        progress_cb("Searching in: " + path.string(), 0, 0);
+                    }
+                    walk_files(path, true, [&](std::vector<ScanEntry>& batch) {
+                        for (auto& entry : batch) {
+                            entry.root = root;
+                        }
+                        // Containers are opened whole once the plain files are done
+                        auto first_container = std::stable_partition(batch.begin(), batch.end(),
+                                                                     [](const ScanEntry& entry) { return !entry.container; });
+                        {
+                            std::lock_guard<std::mutex> lock(walk_mutex);
+                            containers.insert(containers.end(), std::make_move_iterator(first_container),
+                                              std::make_move_iterator(batch.end()));
+                            batch.erase(first_container, batch.end());
+                            if (ordered_output_) {
+                                walked.insert(walked.end(), std::make_move_iterator(batch.begin()),
+                                              std::make_move_iterator(batch.end()));
+                                return;
+                            }
+                        }
+                        feed_files(feed, std::move(batch));
+                    });
+                    if (--walks_running == 0 && !ordered_output_) {
+                        feed.close();
+                    }
+                })
+            );
+        }
+
+        // Path order needs the whole walk
+        if (ordered_output_ || roots.empty()) {
+            for (auto& walk : walks) {
+                walk.wait();
+            }
+            sort_by_path(walked);
+            feed_files(feed, std::move(walked));
+            feed.close();
+        }
+
+        scan_files(feed, progress_cb, result_cb);
+        // A stopped scan stops the walks at their next entry
+        for (auto& walk : walks) {
+            walk.wait();
+        }
+
+        if (ordered_output_) {
+            sort_by_path(containers);
+        }
+        if (!stop_requested_) {
+            scan_containers(containers, progress_cb, result_cb);
+        }
+
+        last_search_completed_ = !stop_requested_;
+        progress_.finish();
+    }
+
+    searching_ = false;
+}
+
+void SearchEngine::search_files(const std::string& search_pattern,
+                               const std::vector<std::filesystem::path>& files,
+                               ProgressCallback progress_cb,
+                               ResultCallback result_cb,
+                               const std::atomic<bool>* cancel) {
+    if (searching_.exchange(true)) {
+        return;
+    }
+
+    // Reset before the token is read: a cancel set at any point after the
+    // caller decided to search stops it, through the token or stop_search()
+    stop_requested_ = false;
+    if (cancel && *cancel) {
+        stop_requested_ = true;
+    }
+    last_search_completed_ = false;
+    result_limit_reached_ = false;
+    clear_results();
+
+    if (!stop_requested_ && compile_pattern(search_pattern, progress_cb)) {
+        progress_.start({});
+
+        std::vector<ScanEntry> entries;
+        std::vector<ScanEntry> containers;
+        std::unordered_set<std::string> seen_containers;
+        entries.reserve(files.size());
+        for (const auto& path : files) {
+            // Entries found inside a container are rescanned through it
+            if (auto container = PakFile::container_of(path)) {
+                if (search_paks_ && seen_containers.insert(container->string()).second) {
+                    containers.push_back({*container, 0, true});
+                }
+                continue;
+            }
+
+            std::error_code ec;
+            auto size = std::filesystem::file_size(path, ec);
+            if (!ec && size >= min_file_size_ && size <= max_file_size_) {
+                entries.push_back({path, size});
+            }
+        }
+
+        if (ordered_output_) {
+            sort_by_path(entries);
+            sort_by_path(containers);
+        }
+
+        ScanFeed feed;
+        const size_t entry_count = entries.size();
+        feed_files(feed, std::move(entries));
+        feed.close();
+
+        scan_files(feed, progress_cb, result_cb, entry_count);
+        if (!stop_requested_) {
+            scan_containers(containers, progress_cb, result_cb);
+        }
+        last_search_completed_ = !stop_requested_;
+        progress_.finish();
+    }
+
+    searching_ = false;
+}
+
+const std::vector<std::string>& SearchEngine::default_excluded_extensions() {
+    // Bulk texture/mesh payloads, audio and video never hold asset references
+    static const std::vector<std::string> extensions = {
+        ".ubulk", ".uptnl", ".wav", ".ogg", ".mp3", ".wem", ".bnk", ".bk2", ".mp4"
+    };
+    return extensions;
+}
+
+void SearchEngine::set_extension_filter(const std::vector<std::string>& include,
+                                        const std::vector<std::string>& exclude) {
+    auto normalize = [](std::string extension) {
+        std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+        if (!extension.empty() && extension[0] != '.') {
+            extension.insert(extension.begin(), '.');
+        }
+        return extension;
+    };
+
+    included_extensions_.clear();
+    excluded_extensions_.clear();
+    for (const auto& extension : include) {
+        if (!extension.empty()) included_extensions_.insert(normalize(extension));
+    }
+    for (const auto& extension : exclude) {
+        if (!extension.empty()) excluded_extensions_.insert(normalize(extension));
+    }
+}
+
+bool SearchEngine::is_extension_allowed(const std::filesystem::path& path) const {
+    if (included_extensions_.empty() && excluded_extensions_.empty()) {
+        return true;
+    }
+
+    std::string extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+
+    if (excluded_extensions_.count(extension) > 0) {
+        return false;
+    }
+    return included_extensions_.empty() || included_extensions_.count(extension) > 0;
+}
+
+bool SearchEngine::is_container(const std::filesystem::path& path) const {
+    if (!search_paks_) {
+        return false;
+    }
+    std::string extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    return extension == ".pak" && excluded_extensions_.count(extension) == 0;
+}
+
+bool SearchEngine::load_ignore_file(const std::filesystem::path& ignore_file) {
+    IgnoreRules rules;
+    if (!rules.load(ignore_file)) {
+        return false;
+    }
+    ignore_rules_ = std::move(rules);
+    return true;
+}
+
+bool SearchEngine::is_ignored(const std::filesystem::path& path, bool is_directory) const {
+    if (ignore_rules_.empty()) {
+        return false;
+    }
+
+    // A path is ignored if it or any directory above it (up to the base) is
+    std::string relative = ignore_rules_.relative_to_base(path);
+    for (size_t slash = relative.find('/'); slash != std::string::npos; slash = relative.find('/', slash + 1)) {
+        if (ignore_rules_.is_ignored(std::string_view(relative).substr(0, slash), true)) {
+            return true;
         }
+    }
+    return ignore_rules_.is_ignored(relative, is_directory);
+}
+
+bool SearchEngine::is_literal_pattern(const std::string& pattern) {
+    return pattern.find_first_of("\\^$.|?*+()[]{}") == std::string::npos;
+}
+
+bool SearchEngine::compile_pattern(const std::string& search_pattern, ProgressCallback progress_cb) {
+    // Literal patterns skip the regex engine; the matcher specializes its
+    // kernel for the case and whole-word options once, here
+    use_literal_matcher_ = !search_pattern.empty() && is_literal_pattern(search_pattern);
+    if (use_literal_matcher_) {
+        literal_matcher_ = scan_kernels::MultiLiteralMatcher({search_pattern}, !case_sensitive_, whole_word_);
+        if (utf16_matching_) {
+            literal_matcher_.add_utf16le(search_pattern);
+        }
+        return true;
+    }
+
+    try {
+        auto syntax = std::regex_constants::ECMAScript;
+        if (!case_sensitive_) {
+            syntax |= std::regex_constants::icase;
+        }
+        compiled_pattern_ = std::regex(whole_word_ ? "\\b(?:" + search_pattern + ")\\b" : search_pattern, syntax);
+        return true;
     } catch (const std::regex_error& e) {
         std::string error_msg = "Invalid regex pattern: " + std::string(e.what());
         if (progress_cb) {
             progress_cb(error_msg, 0, 0);
         }
+        return false;
+    }
+}
+
+bool SearchEngine::build_reference_graph(const std::vector<std::filesystem::path>& search_paths,
+                                         const std::filesystem::path& graph_file,
+                                         ProgressCallback progress_cb) {
+    if (searching_.exchange(true)) {
+        return false;
+    }
+
+    stop_requested_ = false;
+    last_search_completed_ = false;
+
+    std::vector<ScanEntry> packages;
+    for (const auto& path : search_paths) {
+        if (stop_requested_ || !std::filesystem::exists(path)) continue;
+
+        if (progress_cb) {
+            progress_cb("Indexing: " + path.string(), 0, 0);
+        }
+        for (auto& entry : collect_files(path, false)) {
+            std::string extension = entry.path.extension().string();
+            std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+            if (extension == ".uasset" || extension == ".umap") {
+                packages.push_back(std::move(entry));
+            }
+        }
+    }
+
+    ReferenceGraph::Builder builder;
+    std::mutex builder_mutex;
+    std::atomic<size_t> processed_files{0};
+    const size_t total_files = packages.size();
+
+    const size_t batch_size = std::max(static_cast<size_t>(1), packages.size() / thread_count_);
+    std::vector<std::future<void>> futures;
+
+    for (size_t i = 0; i < packages.size() && !stop_requested_; i += batch_size) {
+        size_t end = std::min(i + batch_size, packages.size());
+        futures.emplace_back(std::async(std::launch::async, [&, i, end]() {
+            for (size_t j = i; j < end && !stop_requested_; ++j) {
+                MappedFile file(packages[j].path);
+                if (file.is_open()) {
+                    // Imports and soft references live in the name table, inside the header
+                    std::string_view content = file.content();
+                    size_t header_size = file_classifier::unreal_package_header_size(content);
+                    if (header_size > 0) {
+                        content = content.substr(0, header_size);
+                    }
+                    auto references = ReferenceGraph::extract_references(content);
+
+                    std::lock_guard<std::mutex> lock(builder_mutex);
+                    uint32_t package_id = builder.add_package(packages[j].path);
+                    for (const auto& reference : references) {
+                        builder.add_reference(package_id, reference);
+                    }
+                }
+
+                size_t processed = ++processed_files;
+                if (progress_cb && (processed % 100 == 0 || processed == total_files)) {
+                    progress_cb("Indexing packages...", processed, total_files);
+                }
+            }
+        }));
+    }
+
+    for (auto& future : futures) {
+        future.wait();
+    }
+
+    bool saved = false;
+    if (!stop_requested_) {
+        ReferenceGraph graph = builder.build();
+        saved = graph.save(graph_file);
+        if (progress_cb) {
+            progress_cb(saved ? "Reference graph: " + std::to_string(graph.package_count()) + " packages, " +
+                                    std::to_string(graph.reference_count()) + " references"
+                              : "Could not write " + graph_file.string(),
+                        total_files, total_files);
+        }
     }
 
+    last_search_completed_ = saved;
     searching_ = false;
+    return saved;
 }
 
 void SearchEngine::stop_search() {
@@ -83,201 +418,755 @@ void SearchEngine::clear_results() {
     results_.clear();
 }
 
-void SearchEngine::search_file(const std::filesystem::path& file_path,
+void SearchEngine::search_file(const ScanEntry& entry,
+                              size_t index,
+                              const MappedFile& file,
+                              const ScanPlan& plan,
+                              const uint64_t* sample_hash,
+                              DedupTable& dedup_table,
+                              ResultSequencer* sequencer,
                               ResultCallback result_cb) {
-    if (stop_requested_) {
+    // Mapped, classified and faulted in (up to plan.bytes) by the I/O stage.
+    // Every path below completes the item exactly once, so ordered output
+    // never waits on a skipped file.
+    if (stop_requested_ || !file.is_open() || plan.bytes == 0) {
+        complete_item(sequencer, index, entry.root, {}, result_cb);
         return;
     }
 
-    // Check file size before processing
-    std::error_code ec;
-    auto file_size_check = std::filesystem::file_size(file_path, ec);
-    if (ec || file_size_check < min_file_size_ || file_size_check > max_file_size_) {
-        return;  // Skip files outside size limits or with errors
-    }
-
+    bool completed = false;
+    std::shared_ptr<DedupGroup> owned_group;
     try {
-        // Use memory-mapped file for better performance
-        const char* file_data = nullptr;
-        size_t file_size = 0;
+        std::string_view file_content = file.content().substr(0, plan.bytes);
 
-#ifdef _WIN32
-        HANDLE hFile = CreateFileA(file_path.string().c_str(), GENERIC_READ, FILE_SHARE_READ,
-                                   nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
-        if (hFile == INVALID_HANDLE_VALUE) {
-            return;
-        }
+        if (sample_hash) {
+            // The first file with this sample is matched right away; later
+            // ones pay for a full hash, of themselves and once of the first
+            std::shared_ptr<SampleGroup> sample_group;
+            {
+                std::lock_guard<std::mutex> lock(dedup_table.mutex);
+                auto& slot = dedup_table.samples[*sample_hash];
+                if (!slot) {
+                    slot = std::make_shared<SampleGroup>();
+                    slot->first = entry.path;
+                    slot->first_bytes = file_content.size();
+                    slot->first_group = std::make_shared<DedupGroup>();
+                    slot->first_group->owner = entry.path;
+                    owned_group = slot->first_group;
+                }
+                sample_group = slot;
+            }
 
-        HANDLE hMapping = CreateFileMappingA(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
-        if (hMapping == nullptr) {
-            CloseHandle(hFile);
-            return;
-        }
+            std::shared_ptr<DedupGroup> group = owned_group;
+            uint64_t full_hash = 0;
+            if (!owned_group && full_fingerprint(entry.path, file_content, file_content.size(), full_hash)) {
+                std::lock_guard<std::mutex> lock(sample_group->mutex);
+                if (!sample_group->first_hashed) {
+                    // Read back through the page cache, the first file was just scanned
+                    sample_group->first_hashed = true;
+                    uint64_t first_hash = 0;
+                    if (full_fingerprint(sample_group->first, {}, sample_group->first_bytes, first_hash)) {
+                        sample_group->by_hash[first_hash] = sample_group->first_group;
+                    }
+                }
+
+                auto& slot = sample_group->by_hash[full_hash];
+                if (!slot) {
+                    slot = std::make_shared<DedupGroup>();
+                    slot->owner = entry.path;
+                    owned_group = slot;
+                }
+                group = slot;
+            }
+
+            if (group && !owned_group) {
+                // Same content as a file already claimed: take its verdict
+                duplicate_files_.fetch_add(1, std::memory_order_relaxed);
+                bytes_not_rematched_.fetch_add(file_content.size(), std::memory_order_relaxed);
 
-        file_data = static_cast<const char*>(MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0));
-        if (file_data == nullptr) {
-            CloseHandle(hMapping);
-            CloseHandle(hFile);
-            return;
+                std::vector<SearchResult> duplicates;
+                {
+                    std::lock_guard<std::mutex> lock(group->mutex);
+                    if (!group->done) {
+                        // Completed by the owner once it is matched
+                        group->waiting.emplace_back(&entry, index);
+                        return;
+                    }
+                    duplicates = as_duplicates(group->results, entry.path, group->owner);
+                }
+                completed = true;
+                complete_item(sequencer, index, entry.root, std::move(duplicates), result_cb);
+                return;
+            }
         }
 
-        LARGE_INTEGER fileSize;
-        if (!GetFileSizeEx(hFile, &fileSize)) {
-            UnmapViewOfFile(file_data);
-            CloseHandle(hMapping);
-            CloseHandle(hFile);
-            return;
+        std::vector<SearchResult> matches = match_content(entry.path, file_content, plan);
+
+        std::vector<std::pair<const ScanEntry*, size_t>> waiting;
+        if (owned_group) {
+            std::lock_guard<std::mutex> lock(owned_group->mutex);
+            owned_group->done = true;
+            owned_group->results = matches;
+            waiting.swap(owned_group->waiting);
         }
-        file_size = static_cast<size_t>(fileSize.QuadPart);
 
-#else
-        int fd = open(file_path.c_str(), O_RDONLY);
-        if (fd == -1) {
-            return;
+        completed = true;
+        complete_item(sequencer, index, entry.root, matches, result_cb);
+        for (const auto& [duplicate, duplicate_index] : waiting) {
+            complete_item(sequencer, duplicate_index, duplicate->root,
+                          as_duplicates(matches, duplicate->path, entry.path), result_cb);
+        }
+    } catch (const std::exception&) {
+        // Unreadable files end without results, and so do copies waiting on them
+        if (!completed) {
+            complete_item(sequencer, index, entry.root, {}, result_cb);
+        }
+        if (owned_group && !completed) {
+            std::vector<std::pair<const ScanEntry*, size_t>> waiting;
+            {
+                std::lock_guard<std::mutex> lock(owned_group->mutex);
+                owned_group->done = true;
+                waiting.swap(owned_group->waiting);
+            }
+            for (const auto& [duplicate, duplicate_index] : waiting) {
+                complete_item(sequencer, duplicate_index, duplicate->root, {}, result_cb);
+            }
         }
+    }
+}
+
+void SearchEngine::complete_item(ResultSequencer* sequencer, size_t index, size_t root,
+                                 std::vector<SearchResult> results, ResultCallback result_cb) {
+    if (!sequencer) {
+        publish_results(results, root, result_cb);
+        return;
+    }
 
-        struct stat sb;
-        if (fstat(fd, &sb) == -1) {
-            close(fd);
-            return;
+    // Items finishing early wait for the ones before them; whoever completes
+    // the next expected item releases the run that follows it
+    std::lock_guard<std::mutex> lock(sequencer->mutex);
+    if (index != sequencer->next) {
+        sequencer->pending.emplace(index, std::make_pair(root, std::move(results)));
+        return;
+    }
+
+    publish_results(results, root, result_cb);
+    ++sequencer->next;
+    for (auto it = sequencer->pending.begin();
+         it != sequencer->pending.end() && it->first == sequencer->next;
+         it = sequencer->pending.erase(it)) {
+        publish_results(it->second.second, it->second.first, result_cb);
+        ++sequencer->next;
+    }
+}
+
+SearchEngine::ScanPlan SearchEngine::plan_scan(const std::filesystem::path& file_path,
+                                               std::string_view file_content) const {
+    // Only the first page is touched, and the policy decides how much of
+    // the file is matched at all
+    ScanPlan plan;
+    plan.kind = file_classifier::classify(file_path, file_content);
+    ScanPolicy policy = scan_policies_[static_cast<size_t>(plan.kind)];
+
+    if (policy == ScanPolicy::Skip) {
+        plan.bytes = 0;
+    } else if (policy == ScanPolicy::HeaderOnly) {
+        size_t header_size = plan.kind == FileKind::UnrealPackage
+            ? file_classifier::unreal_package_header_size(file_content)
+            : header_scan_bytes_;
+        plan.bytes = header_size > 0 ? std::min(header_size, file_content.size()) : file_content.size();
+    } else {
+        plan.bytes = file_content.size();
+    }
+    return plan;
+}
+
+uint64_t SearchEngine::readahead_bytes(const ScanEntry& entry) const {
+    // Kinds the file may turn out to be: the name decides packages and
+    // known text files, the content everything else
+    std::vector<FileKind> kinds;
+    if (auto guess = file_classifier::guess_kind(entry.path)) {
+        kinds.push_back(*guess);
+    } else {
+        kinds = {FileKind::Text, FileKind::Binary, FileKind::Compressed};
+    }
+
+    bool full = true;
+    bool header_only = true;
+    for (FileKind kind : kinds) {
+        ScanPolicy policy = scan_policies_[static_cast<size_t>(kind)];
+        full = full && policy == ScanPolicy::Full;
+        header_only = header_only && policy == ScanPolicy::HeaderOnly;
+    }
+
+    // Unsure cases read just what classification needs; the I/O stage asks
+    // for the exact range once the first page is in
+    if (full) {
+        return entry.size;
+    }
+    if (header_only) {
+        return std::min<uint64_t>(entry.size, std::max(header_scan_bytes_, file_classifier::sample_size));
+    }
+    return std::min<uint64_t>(entry.size, file_classifier::sample_size);
+}
+
+std::vector<SearchResult> SearchEngine::match_content(const std::filesystem::path& file_path,
+                                                      std::string_view file_content) {
+    ScanPlan plan = plan_scan(file_path, file_content);
+    return match_content(file_path, file_content.substr(0, plan.bytes), plan);
+}
+
+std::vector<SearchResult> SearchEngine::match_content(const std::filesystem::path& file_path,
+                                                      std::string_view file_content,
+                                                      const ScanPlan& plan) {
+    if (plan.bytes == 0) {
+        return {};
+    }
+    bool is_text = plan.kind == FileKind::Text;
+
+    if (all_matches_) {
+        return collect_all_matches(file_path, file_content, is_text);
+    }
+
+    std::vector<SearchResult> matches;
+    size_t match_pos = 0;
+    size_t match_len = 0;
+    if (find_match(file_content, 0, match_pos, match_len)) {
+        // For binary files, we'll just report "binary content" as the line
+        std::string content_preview = "Binary content match";
+        size_t line_number = 0;
+
+        if (is_text) {
+            line_number = 1 + scan_kernels::count_newlines(file_content.data(), file_content.data() + match_pos);
+
+            // Show the first 1000 chars as preview
+            std::string preview_str(file_content.substr(0, 1000));
+            // Replace newlines with spaces for single-line display
+            std::replace(preview_str.begin(), preview_str.end(), '\n', ' ');
+            std::replace(preview_str.begin(), preview_str.end(), '\r', ' ');
+            content_preview = std::move(preview_str);
         }
-        file_size = static_cast<size_t>(sb.st_size);
 
-        file_data = static_cast<const char*>(mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0));
-        if (file_data == MAP_FAILED) {
-            close(fd);
-            return;
+        matches.emplace_back(file_path, content_preview, line_number, match_pos);
+    }
+    return matches;
+}
+
+void SearchEngine::publish_results(const std::vector<SearchResult>& results, size_t root, ResultCallback result_cb) {
+    if (results.empty()) {
+        return;
+    }
+
+    // Past the limit nothing is published, and reaching it cancels the scan
+    auto end = results.end();
+    {
+        std::lock_guard<std::mutex> lock(results_mutex_);
+        if (result_limit_ > 0) {
+            size_t room = result_limit_ > results_.size() ? result_limit_ - results_.size() : 0;
+            if (room <= results.size()) {
+                end = results.begin() + room;
+                result_limit_reached_ = true;
+                stop_requested_ = true;
+            }
         }
-#endif
+        results_.insert(results_.end(), results.begin(), end);
+    }
+
+    progress_.add_hits(root, end - results.begin());
 
-        if (file_size == 0 || file_data == nullptr) {
-#ifdef _WIN32
-            UnmapViewOfFile(file_data);
-            CloseHandle(hMapping);
-            CloseHandle(hFile);
-#else
-            munmap(const_cast<char*>(file_data), file_size);
-            close(fd);
-#endif
-            return;
+    if (result_cb) {
+        for (auto result = results.begin(); result != end; ++result) {
+            result_cb(*result);
         }
+    }
+}
+
+std::vector<SearchResult> SearchEngine::as_duplicates(const std::vector<SearchResult>& results,
+                                                      const std::filesystem::path& file_path,
+                                                      const std::filesystem::path& owner) {
+    std::vector<SearchResult> duplicates = results;
+    for (auto& duplicate : duplicates) {
+        duplicate.file_path = file_path;
+        duplicate.duplicate_of = owner;
+    }
+    return duplicates;
+}
+
+bool SearchEngine::find_match(std::string_view content, size_t from,
+                              size_t& match_pos, size_t& match_len) const {
+    if (use_literal_matcher_) {
+        return literal_matcher_.find(content, from, match_pos, match_len);
+    }
 
-        // Search in memory-mapped data (much faster than loading into string)
-        std::string_view file_content(file_data, file_size);
+    // match_prev_avail lets ^ and \b see the byte before a resumed search
+    auto flags = from > 0 ? std::regex_constants::match_prev_avail : std::regex_constants::match_default;
+    std::cmatch match;
+    if (!std::regex_search(content.data() + from, content.data() + content.size(), match, compiled_pattern_, flags)) {
+        return false;
+    }
+    match_pos = from + static_cast<size_t>(match.position(0));
+    match_len = static_cast<size_t>(match.length(0));
+    return true;
+}
 
-        if (std::regex_search(file_content.begin(), file_content.end(), compiled_pattern_)) {
-            // For binary files, we'll just report "binary content" as the line
-            std::string content_preview = "Binary content match";
+std::vector<SearchResult> SearchEngine::collect_all_matches(const std::filesystem::path& file_path,
+                                                            std::string_view content,
+                                                            bool is_text) {
+    // Longest part of a single match shown in its context window
+    constexpr size_t max_match_preview = 256;
 
-            // If it looks like text (no null bytes in first 1000 chars), show preview
-            size_t preview_size = std::min<size_t>(1000, file_content.length());
-            std::string_view preview = file_content.substr(0, preview_size);
+    std::vector<SearchResult> matches;
+    size_t from = 0;
+    size_t line = 1;
+    size_t counted_up_to = 0;
+    size_t match_pos = 0;
+    size_t match_len = 0;
 
-            bool is_likely_text = std::find(preview.begin(), preview.end(), '\0') == preview.end();
-            if (is_likely_text) {
-                std::string preview_str(preview);
-                // Replace newlines with spaces for single-line display
-                std::replace(preview_str.begin(), preview_str.end(), '\n', ' ');
-                std::replace(preview_str.begin(), preview_str.end(), '\r', ' ');
-                content_preview = std::move(preview_str);
-            }
+    while (from <= content.size() && matches.size() < max_matches_per_file_ && !stop_requested_ &&
+           find_match(content, from, match_pos, match_len)) {
+        size_t window_begin = match_pos - std::min(match_pos, context_bytes_);
+        size_t window_end = std::min(content.size(), match_pos + std::min(match_len, max_match_preview) + context_bytes_);
+        size_t line_number = 0;
 
-            SearchResult result(file_path, content_preview, 1);
+        if (is_text) {
+            // Newlines are counted incrementally, so the whole file is walked once
+            line += scan_kernels::count_newlines(content.data() + counted_up_to, content.data() + match_pos);
+            counted_up_to = match_pos;
+            line_number = line;
 
-            {
-                std::lock_guard<std::mutex> lock(results_mutex_);
-                results_.push_back(result);
+            // Keep the context window on the matching line
+            std::string_view before = content.substr(window_begin, match_pos - window_begin);
+            size_t newline = before.rfind('\n');
+            if (newline != std::string_view::npos) {
+                window_begin += newline + 1;
+            }
+            size_t after_begin = std::min(match_pos + match_len, window_end);
+            std::string_view after = content.substr(after_begin, window_end - after_begin);
+            newline = after.find('\n');
+            if (newline != std::string_view::npos) {
+                window_end = after_begin + newline;
             }
+        }
 
-            if (result_cb) {
-                result_cb(result);
+        std::string context(content.substr(window_begin, window_end - window_begin));
+        for (auto& c : context) {
+            auto byte = static_cast<unsigned char>(c);
+            if (byte == '\r' || byte == '\n' || byte == '\t') {
+                c = ' ';
+            } else if (!is_text && (byte < 0x20 || byte >= 0x7f)) {
+                c = '.';
             }
         }
 
-        // Clean up memory mapping
-#ifdef _WIN32
-        UnmapViewOfFile(file_data);
-        CloseHandle(hMapping);
-        CloseHandle(hFile);
-#else
-        munmap(const_cast<char*>(file_data), file_size);
-        close(fd);
-#endif
-    } catch (const std::exception&) {
-        // Silently handle file read errors
+        matches.emplace_back(file_path, context, line_number, match_pos);
+
+        // Skip past this match; step one byte on empty matches
+        from = match_pos + std::max<size_t>(match_len, 1);
     }
+
+    return matches;
 }
 
-void SearchEngine::search_directory_worker(const std::filesystem::path& dir_path,
-                                         ProgressCallback progress_cb,
-                                         ResultCallback result_cb) {
-    if (stop_requested_) {
-        return;
+void SearchEngine::feed_files(ScanFeed& feed, std::vector<ScanEntry> files) {
+    std::vector<FeedItem> items;
+    items.reserve(files.size());
+    for (auto& entry : files) {
+        progress_.add_total(entry.root, 1, entry.size);
+        // Hints and populated mappings cover what the policy will match, as
+        // far as the name tells before the file is classified
+        uint64_t readahead = readahead_bytes(entry);
+        items.push_back({std::move(entry), readahead, {}, 0});
     }
-    try {
-        auto files = collect_files(dir_path);
-        size_t total_files = files.size();
-        size_t processed_files = 0;
+    feed.add(std::move(items));
+}
 
+void SearchEngine::scan_files(ScanFeed& feed,
+                              ProgressCallback progress_cb,
+                              ResultCallback result_cb,
+                              size_t max_files) {
+    duplicate_files_ = 0;
+    bytes_not_rematched_ = 0;
+    DedupTable dedup_table;
+    ResultSequencer ordered;
+    ResultSequencer* sequencer = ordered_output_ ? &ordered : nullptr;
 
-        if (progress_cb) {
-            progress_cb("Searching in: " + dir_path.string(), processed_files, total_files);
+    // I/O and matching run as separate stages that size themselves: many
+    // blocked readers on cold drives, about one matcher per core when cached
+    ScanPipeline pipeline(io_limits_, match_limits_, std::max<size_t>(1, match_limits_.max_workers) * 4);
+    Prefetcher prefetcher(
+        [&feed](size_t index) {
+            FeedItem* item = feed.peek(index);
+            return item ? Prefetcher::Range{&item->entry.path, item->readahead} : Prefetcher::Range{nullptr, 0};
+        },
+        prefetch_min_depth_, prefetch_max_depth_);
+
+    // Small files matched whole are read by the mmap call itself instead of
+    // page by page
+    constexpr uint64_t populate_limit = 64 * 1024;
+
+    auto stats = pipeline.run(
+        [this, &feed](size_t& index) { return feed.claim(index, stop_requested_); },
+        [this, &feed, &prefetcher](size_t index, MappedFile& file) {
+            // Entries the I/O stage reaches next are read while this one loads
+            prefetcher.advance(index);
+
+            auto start = std::chrono::steady_clock::now();
+            // The plan and sample hash are read by the match stage after the handoff
+            FeedItem& item = feed.at(index);
+            bool populate = item.entry.size <= populate_limit && item.readahead == item.entry.size;
+            if (file.open(item.entry.path, populate)) {
+                // Classified from the first page; only what the policy
+                // matches is faulted in (nothing for skipped kinds)
+                if (!populate) {
+                    file.disable_readahead();
+                }
+                item.plan = plan_scan(item.entry.path, file.content());
+                if (!populate) {
+                    file.prefault(item.plan.bytes, stop_requested_);
+                }
+                if (deduplicate_ && item.plan.bytes > 0) {
+                    // Same bytes read as another kind (text vs. binary) report differently
+                    item.sample_hash = content_fingerprint::sampled_hash(file.content().substr(0, item.plan.bytes)) ^
+                                       (static_cast<uint64_t>(item.plan.kind) * 0x9E3779B97F4A7C15ULL);
+                }
+            }
+            prefetcher.record(std::chrono::steady_clock::now() - start);
+        },
+        [this, &feed, &dedup_table, sequencer, result_cb](size_t index, const MappedFile& file) {
+            const FeedItem& item = feed.at(index);
+            search_file(item.entry, index, file, item.plan, deduplicate_ ? &item.sample_hash : nullptr,
+                        dedup_table, sequencer, result_cb);
+            progress_.add_done(item.entry.root, 1, item.entry.size);
+        },
+        stop_requested_, max_files);
+
+    {
+        std::lock_guard<std::mutex> lock(results_mutex_);
+        pipeline_stats_ = stats;
+    }
+
+    if (progress_cb && duplicate_files_ > 0) {
+        progress_cb(std::to_string(duplicate_files_.load()) + " identical files not rematched (" +
+                    std::to_string(bytes_not_rematched_.load() / 1024) + " KB)",
+                    feed.claimed(), feed.claimed());
+    }
+}
+
+void SearchEngine::scan_containers(const std::vector<ScanEntry>& containers,
+                                   ProgressCallback progress_cb,
+                                   ResultCallback result_cb) {
+    for (const auto& container : containers) {
+        if (stop_requested_) {
+            break;
         }
 
-        // Process files in batches for better load balancing
-        const size_t batch_size = std::max(static_cast<size_t>(1), files.size() / thread_count_);
-        std::vector<std::future<void>> file_futures;
+        const std::string container_name = container.path.filename().string();
+        PakFile pak;
+        if (!pak.open(container.path)) {
+            if (progress_cb) {
+                progress_cb("Skipped " + container_name + ": " + pak.error(), 0, 0);
+            }
+            continue;
+        }
 
-        for (size_t i = 0; i < files.size() && !stop_requested_; i += batch_size) {
-            size_t end = std::min(i + batch_size, files.size());
+        // Entries get the same size and extension filters as files
+        std::vector<const PakFile::Entry*> entries;
+        uint64_t entry_bytes = 0;
+        size_t unreadable = 0;
+        for (const auto& entry : pak.entries()) {
+            if (entry.uncompressed_size < min_file_size_ || entry.uncompressed_size > max_file_size_ ||
+                !is_extension_allowed(std::filesystem::path(entry.name))) {
+                continue;
+            }
+            if (entry.encrypted || entry.compression == PakFile::Compression::Unsupported ||
+                (entry.compression == PakFile::Compression::Zlib && !PakFile::zlib_available())) {
+                ++unreadable;
+                continue;
+            }
+            entries.push_back(&entry);
+            entry_bytes += entry.uncompressed_size;
+        }
 
-            file_futures.emplace_back(
-                std::async(std::launch::async, [this, &files, i, end, result_cb, progress_cb, &processed_files, total_files]() {
-                    for (size_t j = i; j < end && !stop_requested_; ++j) {
-                        search_file(files[j], result_cb);
+        if (ordered_output_) {
+            std::sort(entries.begin(), entries.end(),
+                      [](const PakFile::Entry* a, const PakFile::Entry* b) { return a->name < b->name; });
+        }
 
-                        ++processed_files;
-                        if (progress_cb && (processed_files % 10 == 0 || processed_files == total_files)) {
-                            progress_cb("Processing files...", processed_files, total_files);
-                        }
+        const size_t total_entries = entries.size();
+        progress_.add_total(container.root, total_entries, entry_bytes);
+        if (progress_cb) {
+            progress_cb("Searching " + container_name + " (" + std::to_string(total_entries) + " entries)",
+                        0, total_entries);
+        }
+
+        // Entries are handed out one at a time in index order, so completions
+        // stay close to it and ordered output holds back only a few results
+        const size_t worker_count = std::min<size_t>(thread_count_, entries.size());
+        std::atomic<size_t> next_entry{0};
+        std::vector<std::future<void>> futures;
+
+        ResultSequencer ordered;
+        ResultSequencer* sequencer = ordered_output_ ? &ordered : nullptr;
+        for (size_t worker = 0; worker < worker_count; ++worker) {
+            futures.emplace_back(std::async(std::launch::async, [&]() {
+                // One inflate buffer per worker, reused for all its entries
+                std::string buffer;
+                while (!stop_requested_) {
+                    size_t j = next_entry.fetch_add(1);
+                    if (j >= entries.size()) {
+                        break;
                     }
-                })
-            );
+                    std::string_view content;
+                    std::vector<SearchResult> results;
+                    if (pak.read(*entries[j], buffer, content)) {
+                        results = match_content(PakFile::virtual_path(container.path, *entries[j]), content);
+                    }
+                    complete_item(sequencer, j, container.root, std::move(results), result_cb);
+                    progress_.add_done(container.root, 1, entries[j]->uncompressed_size);
+                }
+            }));
         }
 
-        for (auto& future : file_futures) {
+        for (auto& future : futures) {
             future.wait();
         }
 
-    } catch (const std::filesystem::filesystem_error& e) {
-        std::string error_msg = "Error accessing: " + dir_path.string() + " - " + e.what();
-        if (progress_cb) {
-            progress_cb(error_msg, 0, 0);
+        if (progress_cb && unreadable > 0) {
+            progress_cb(container_name + ": " + std::to_string(unreadable) + " encrypted or unsupported entries skipped",
+                        total_entries, total_entries);
+        }
+    }
+}
+
+void SearchEngine::sort_by_path(std::vector<ScanEntry>& files) {
+    std::sort(files.begin(), files.end(),
+              [](const ScanEntry& a, const ScanEntry& b) { return a.path < b.path; });
+}
+
+SearchEngine::ScanFeed::ScanFeed(const std::string& proximity_pattern)
+    : pending_(proximity_pattern.empty() ? 1 : rank_buckets_), needle_(proximity_pattern) {
+    std::transform(needle_.begin(), needle_.end(), needle_.begin(), ::tolower);
+}
+
+void SearchEngine::ScanFeed::add(std::vector<FeedItem> items) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const size_t known_anchors = anchors_.size();
+        for (auto& item : items) {
+            items_.push_back(std::move(item));
+            Pending pending;
+            pending.item = &items_.back();
+            if (needle_.empty()) {
+                pending_[0].push_back(std::move(pending));
+                continue;
+            }
+
+            // Files named like the pattern are the assets being asked about;
+            // their folders (and the plugin around them) hold the likeliest referencers
+            const auto& path = pending.item->entry.path;
+            pending.folder = path.parent_path().string();
+            std::string stem = path.stem().string();
+            std::transform(stem.begin(), stem.end(), stem.begin(), ::tolower);
+            pending.named = stem.find(needle_) != std::string::npos;
+            if (pending.named && anchors_.size() < max_anchors_ &&
+                std::find(anchors_.begin(), anchors_.end(), pending.folder) == anchors_.end()) {
+                anchors_.push_back(pending.folder);
+            }
+            rank(pending, 0);
+            pending_[std::min(pending.rank, rank_buckets_ - 1)].push_back(std::move(pending));
+        }
+
+        // Files still waiting may sit next to a folder found in this batch
+        if (anchors_.size() > known_anchors) {
+            std::vector<std::deque<Pending>> ranked(rank_buckets_);
+            for (auto& bucket : pending_) {
+                for (auto& pending : bucket) {
+                    rank(pending, known_anchors);
+                    ranked[std::min(pending.rank, rank_buckets_ - 1)].push_back(std::move(pending));
+                }
+            }
+            pending_ = std::move(ranked);
         }
     }
+    cv_.notify_all();
+}
+
+void SearchEngine::ScanFeed::rank(Pending& pending, size_t first_anchor) const {
+    // The named assets themselves go after their neighbours: a package
+    // always contains its own name, which does not answer "who uses it"
+    for (size_t i = first_anchor; i < anchors_.size(); ++i) {
+        pending.rank = std::min(pending.rank, folder_distance(anchors_[i], pending.folder) * 2 + pending.named);
+    }
 }
 
-std::vector<std::filesystem::path> SearchEngine::collect_files(const std::filesystem::path& directory) {
-    std::vector<std::filesystem::path> files;
+void SearchEngine::ScanFeed::close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+    }
+    cv_.notify_all();
+}
+
+bool SearchEngine::ScanFeed::commit(size_t count) {
+    // Claim order is fixed item by item, best rank first, so items already
+    // hinted or loaded keep their index while the walk adds more
+    while (order_.size() < count) {
+        auto bucket = std::find_if(pending_.begin(), pending_.end(),
+                                   [](const std::deque<Pending>& pending) { return !pending.empty(); });
+        if (bucket == pending_.end()) {
+            return false;
+        }
+        order_.push_back(bucket->front().item);
+        bucket->pop_front();
+    }
+    return true;
+}
+
+bool SearchEngine::ScanFeed::claim(size_t& index, const std::atomic<bool>& stop) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stop) {
+        if (commit(next_claim_ + 1)) {
+            index = next_claim_++;
+            return true;
+        }
+        if (closed_) {
+            return false;
+        }
+        // Stop requests do not notify; look again shortly
+        cv_.wait_for(lock, std::chrono::milliseconds(20));
+    }
+    return false;
+}
+
+SearchEngine::FeedItem* SearchEngine::ScanFeed::peek(size_t index) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return commit(index + 1) ? order_[index] : nullptr;
+}
+
+SearchEngine::FeedItem& SearchEngine::ScanFeed::at(size_t index) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return *order_[index];
+}
+
+size_t SearchEngine::ScanFeed::claimed() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return next_claim_;
+}
+
+bool SearchEngine::full_fingerprint(const std::filesystem::path& path, std::string_view content, size_t length,
+                                    uint64_t& hash) {
+    // Only hashes of whole files are cached: the prefix length follows the policy
+    content_fingerprint::FileIdentity identity;
+    bool cacheable = content_fingerprint::read_file_identity(path, identity) && identity.size == length;
+    if (cacheable && fingerprint_cache_.lookup(identity, hash)) {
+        return true;
+    }
+
+    // Without content the file is mapped here
+    MappedFile file;
+    if (content.empty()) {
+        if (!file.open(path) || file.size() < length) {
+            return false;
+        }
+        content = file.content().substr(0, length);
+    }
+
+    hash = content_fingerprint::xxhash64(content.data(), content.size(), content.size());
+    if (cacheable) {
+        fingerprint_cache_.store(identity, hash);
+    }
+    return true;
+}
+
+std::vector<SearchEngine::ScanEntry> SearchEngine::collect_files(const std::filesystem::path& directory, bool apply_size_limits) {
+    std::vector<ScanEntry> files;
+    walk_files(directory, apply_size_limits, [&files](std::vector<ScanEntry>& batch) {
+        files.insert(files.end(), std::make_move_iterator(batch.begin()), std::make_move_iterator(batch.end()));
+    });
+    return files;
+}
+
+void SearchEngine::walk_files(const std::filesystem::path& directory, bool apply_size_limits,
+                              const std::function<void(std::vector<ScanEntry>&)>& flush) {
+    // Small batches: the scan starts on the first files found
+    constexpr size_t batch_size = 64;
+    std::vector<ScanEntry> files;
     size_t directory_count = 0;
     size_t file_count = 0;
 
+    if (is_ignored(directory, true)) {
+        return;
+    }
+
+    // Rules see paths relative to their base; entries are relative to the root
+    std::string root_prefix;
+    if (!ignore_rules_.empty()) {
+        root_prefix = ignore_rules_.relative_to_base(directory);
+        if (!root_prefix.empty()) {
+            root_prefix += '/';
+        }
+    }
+    const size_t root_length = directory.generic_string().size();
+
     try {
-        for (const auto& entry : std::filesystem::recursive_directory_iterator(directory)) {
+        for (auto it = std::filesystem::recursive_directory_iterator(directory);
+             it != std::filesystem::recursive_directory_iterator(); ++it) {
             if (stop_requested_) {
                 break;
             }
 
-            if (entry.is_directory()) {
+            const auto& entry = *it;
+            bool is_directory = entry.is_directory();
+
+            if (!ignore_rules_.empty()) {
+                std::string entry_path = entry.path().generic_string();
+                size_t name_start = std::min(root_length, entry_path.size());
+                if (name_start < entry_path.size() && entry_path[name_start] == '/') {
+                    ++name_start;
+                }
+
+                if (ignore_rules_.is_ignored(root_prefix + entry_path.substr(name_start), is_directory)) {
+                    // Prune the whole subtree before it is opened
+                    if (is_directory) {
+                        it.disable_recursion_pending();
+                    }
+                    continue;
+                }
+            }
+
+            if (is_directory) {
                 directory_count++;
             } else if (entry.is_regular_file()) {
-                files.push_back(entry.path());
-                file_count++;
+                // The reference graph may be written inside the tree; it lists
+                // every package and asset name and would match most patterns
+                if (ReferenceGraph::is_graph_file(entry.path())) {
+                    continue;
+                }
+
+                bool container = is_container(entry.path());
+                if (!container && !is_extension_allowed(entry.path())) {
+                    continue;
+                }
+
+                // Size limits are applied here so skipped files are never
+                // opened; containers are limited entry by entry instead
+                std::error_code ec;
+                uint64_t size = entry.file_size(ec);
+                if (!ec && (container || !apply_size_limits || (size >= min_file_size_ && size <= max_file_size_))) {
+                    files.push_back({entry.path(), size, container});
+                    file_count++;
+                    if (files.size() >= batch_size) {
+                        flush(files);
+                        files.clear();
+                    }
+                }
             }
         }
     } catch (const std::filesystem::filesystem_error&) {
         // Silently handle filesystem errors during collection
     }
 
-    return files;
+    if (!files.empty()) {
+        flush(files);
+    }
 }
\ No newline at end of file
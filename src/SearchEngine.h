@@ -1,22 +1,42 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
+#include <algorithm>
 #include <future>
 #include <functional>
 #include <filesystem>
 #include <regex>
 #include <mutex>
 #include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <memory>
+#include <cstdint>
+
+#include "ContentFingerprint.h"
+#include "FileClassifier.h"
+#include "IgnoreRules.h"
+#include "PakFile.h"
+#include "ReferenceGraph.h"
+#include "ScanKernels.h"
+#include "ScanPipeline.h"
+#include "ScanProgress.h"
 
 struct SearchResult
 {
     std::filesystem::path file_path;
     std::string line_content;
-    size_t line_number;
+    size_t line_number;  // 0 when the file is binary
+    size_t byte_offset;  // Offset of the match within the file
+    std::filesystem::path duplicate_of; // Set when the verdict was shared from an identical file
 
-    SearchResult(const std::filesystem::path &path, const std::string &content, size_t line_num)
-        : file_path(path), line_content(content), line_number(line_num) {}
+    SearchResult(const std::filesystem::path &path, const std::string &content, size_t line_num, size_t offset = 0)
+        : file_path(path), line_content(content), line_number(line_num), byte_offset(offset) {}
 };
 
 class SearchEngine
@@ -34,38 +54,377 @@ public:
         max_file_size_ = max_size;
     }
 
+    // Report every match instead of only the first one per file. Each match
+    // carries its offset, its line number in text files and a context window
+    // of up to context_bytes on each side.
+    void set_all_matches(bool enabled, size_t max_matches_per_file = 100, size_t context_bytes = 40)
+    {
+        all_matches_ = enabled;
+        max_matches_per_file_ = std::max<size_t>(1, max_matches_per_file);
+        context_bytes_ = context_bytes;
+    }
+    bool all_matches() const { return all_matches_; }
+
+    // Also match literal patterns stored as UTF-16LE (FStrings and non-ASCII
+    // names inside Unreal packages). Both encodings are found in one pass.
+    // Regex patterns keep matching bytes only.
+    void set_utf16_matching(bool enabled) { utf16_matching_ = enabled; }
+
+    // Matching is case insensitive by default. Whole-word matches must not
+    // touch a letter, digit or underscore at either end that continues the
+    // word (regex patterns are wrapped in \b...\b).
+    void set_case_sensitive(bool enabled) { case_sensitive_ = enabled; }
+    bool case_sensitive() const { return case_sensitive_; }
+    void set_whole_word(bool enabled) { whole_word_ = enabled; }
+    bool whole_word() const { return whole_word_; }
+
+    // What to match for each kind of file. Kinds are decided up front from
+    // magic numbers, known text extensions and a NUL/entropy sample.
+    void set_scan_policy(FileKind kind, ScanPolicy policy) { scan_policies_[static_cast<size_t>(kind)] = policy; }
+    ScanPolicy get_scan_policy(FileKind kind) const { return scan_policies_[static_cast<size_t>(kind)]; }
+
+    // Bytes matched under ScanPolicy::HeaderOnly for kinds without a parsed header
+    void set_header_scan_bytes(size_t bytes) { header_scan_bytes_ = bytes; }
+
+    // Extension filters (".ubulk", case insensitive) applied while walking the
+    // tree, so filtered files are never opened. An empty include list keeps all.
+    void set_extension_filter(const std::vector<std::string> &include, const std::vector<std::string> &exclude);
+    static const std::vector<std::string> &default_excluded_extensions();
+
+    // Exclusion rules from a .searchignore file. Ignored directories are
+    // pruned during the walk, before they are opened.
+    bool load_ignore_file(const std::filesystem::path &ignore_file);
+    void clear_ignore_rules() { ignore_rules_ = IgnoreRules(); }
+    bool is_ignored(const std::filesystem::path &path, bool is_directory) const;
+
+    // Scan byte-identical files once and share the verdict. Only the bytes
+    // the scan policy matches are compared. The I/O stage hashes their size
+    // and a few sampled blocks from its mapping; a full hash is only computed
+    // once another file shares that sample. Whole-file hashes are cached by
+    // (device, inode, mtime) across searches.
+    struct DedupStats
+    {
+        size_t duplicate_files = 0;
+        uint64_t bytes_not_rematched = 0; // Still read and hashed, only the matching was skipped
+    };
+    void set_deduplication(bool enabled) { deduplicate_ = enabled; }
+    DedupStats get_dedup_stats() const { return {duplicate_files_.load(), bytes_not_rematched_.load()}; }
+
+    // Search inside .pak containers found while walking. Their entries are
+    // matched like files (size limits apply to the uncompressed size) and
+    // reported as Game.pak!/Content/...; containers themselves ignore the
+    // size limits and the include filter.
+    void set_pak_search(bool enabled) { search_paks_ = enabled; }
+
+    // Report results in path order, identical from run to run. Files are
+    // still matched in parallel; results that finish early wait in a small
+    // buffer until every file before them is done, then stream out.
+    void set_ordered_output(bool enabled) { ordered_output_ = enabled; }
+
+    // Stop as soon as this many results are found (0: no limit); 1 answers
+    // "is it used anywhere". Limited literal searches scan the folders and
+    // plugin of files named like the pattern first, as soon as the walk
+    // finds them.
+    void set_result_limit(size_t limit) { result_limit_ = limit; }
+    // True if the last search ended because it reached the limit
+    bool result_limit_reached() const { return result_limit_reached_; }
+
+    // `cancel` is owned by the caller. Setting it and then calling
+    // stop_search() stops this search even if both happen before the call,
+    // which stop_search() alone cannot do: a new search clears the stop flag.
     void search(const std::string &search_pattern,
                 const std::vector<std::filesystem::path> &search_paths,
                 ProgressCallback progress_cb = nullptr,
-                ResultCallback result_cb = nullptr);
+                ResultCallback result_cb = nullptr,
+                const std::atomic<bool> *cancel = nullptr);
+
+    // Re-checks only the given files, e.g. the matches of a previous search
+    // when the new pattern can only match a subset of them
+    void search_files(const std::string &search_pattern,
+                      const std::vector<std::filesystem::path> &files,
+                      ProgressCallback progress_cb = nullptr,
+                      ResultCallback result_cb = nullptr,
+                      const std::atomic<bool> *cancel = nullptr);
+
+    // Reads every package (.uasset/.umap) under the paths once and writes a
+    // reverse-reference graph to graph_file. Size limits don't apply here.
+    // Later "who references X" questions are answered by ReferenceGraph
+    // lookups, with no file I/O.
+    bool build_reference_graph(const std::vector<std::filesystem::path> &search_paths,
+                               const std::filesystem::path &graph_file,
+                               ProgressCallback progress_cb = nullptr);
 
     void stop_search();
     bool is_searching() const { return searching_; }
 
+    // True if the last search ran to the end without being stopped
+    bool last_search_completed() const { return last_search_completed_; }
+
+    // True if the pattern has no regex metacharacters
+    static bool is_literal_pattern(const std::string &pattern);
+
     const std::vector<SearchResult> &get_results() const { return results_; }
     void clear_results();
 
-    void set_thread_count(size_t threads) { thread_count_ = threads; }
+    // Safe while a search is running: results are visited under the results
+    // lock, so `visit` must not call back into the engine. False stops early.
+    size_t result_count() const
+    {
+        std::lock_guard<std::mutex> lock(results_mutex_);
+        return results_.size();
+    }
+    void for_each_result(const std::function<bool(const SearchResult &)> &visit) const
+    {
+        std::lock_guard<std::mutex> lock(results_mutex_);
+        for (const auto &result : results_)
+        {
+            if (!visit(result))
+                break;
+        }
+    }
+
+    // Also the upper bound of the match stage
+    void set_thread_count(size_t threads)
+    {
+        thread_count_ = std::max<size_t>(1, threads);
+        match_limits_.max_workers = thread_count_;
+    }
     size_t get_thread_count() const { return thread_count_; }
 
+    // Worker bounds of the two scan stages. I/O workers open and fault in
+    // files (many help on cold network drives), match workers run the
+    // kernels. Each stage tunes its width within its bounds during a scan.
+    void set_io_threads(size_t min_threads, size_t max_threads) { io_limits_ = {min_threads, max_threads}; }
+    void set_match_threads(size_t min_threads, size_t max_threads) { match_limits_ = {min_threads, max_threads}; }
+
+    // Files hinted for readahead ahead of the I/O stage. The depth moves
+    // within these bounds with measured load latency; max 0 disables hints.
+    void set_prefetch_depth(size_t min_depth, size_t max_depth)
+    {
+        prefetch_min_depth_ = min_depth;
+        prefetch_max_depth_ = max_depth;
+    }
+
+    // Live file, byte and hit counters per search root, cheap to sample
+    // while a search runs
+    ScanProgress::Sample sample_progress() { return progress_.sample(); }
+
+    // Stage widths the last scan settled on
+    ScanPipeline::Stats get_pipeline_stats() const
+    {
+        std::lock_guard<std::mutex> lock(results_mutex_);
+        return pipeline_stats_;
+    }
+
 private:
-    void search_file(const std::filesystem::path &file_path,
+    struct ScanEntry
+    {
+        std::filesystem::path path;
+        uint64_t size;
+        bool container = false; // .pak scanned entry by entry
+        uint32_t root = 0;      // Index of the search path it was found under
+    };
+
+    // Identical files seen during one scan: the first one (owner) is matched,
+    // the others take its verdict, now or when the owner finishes
+    struct DedupGroup
+    {
+        std::mutex mutex;
+        bool done = false;
+        std::filesystem::path owner;
+        std::vector<SearchResult> results;
+        std::vector<std::pair<const ScanEntry *, size_t>> waiting; // Copies and their scan index
+    };
+
+    // Files sharing a sampled hash. The first one is matched without a full
+    // hash and only hashed once a second file collides with it.
+    struct SampleGroup
+    {
+        std::mutex mutex;
+        std::filesystem::path first;
+        size_t first_bytes = 0; // Its matched prefix, all that is hashed
+        std::shared_ptr<DedupGroup> first_group;
+        bool first_hashed = false;
+        std::unordered_map<uint64_t, std::shared_ptr<DedupGroup>> by_hash; // Full hash -> group
+    };
+
+    struct DedupTable
+    {
+        std::mutex mutex;
+        std::unordered_map<uint64_t, std::shared_ptr<SampleGroup>> samples;
+    };
+
+    // How much of a file its scan policy matches, decided by the I/O stage
+    // from the first page so the rest is only read when it will be matched
+    struct ScanPlan
+    {
+        FileKind kind = FileKind::Binary;
+        size_t bytes = 0; // Prefix to match, 0 under ScanPolicy::Skip
+    };
+
+    // Results of items completed in any order, released in item order
+    struct ResultSequencer
+    {
+        std::mutex mutex;
+        size_t next = 0;
+        std::map<size_t, std::pair<size_t, std::vector<SearchResult>>> pending; // index -> (root, results)
+    };
+
+    // A walked file, and what the I/O stage found out about it for the match stage
+    struct FeedItem
+    {
+        ScanEntry entry;
+        uint64_t readahead = 0; // Bytes worth hinting before the file is classified
+        ScanPlan plan;
+        uint64_t sample_hash = 0;
+    };
+
+    // Files handed from the directory walk to the scan while the walk still
+    // runs, so matching starts with the first files found. Items are numbered
+    // in the order the scan claims them: walk order, or with a proximity
+    // pattern the folders nearest to files named like it first.
+    class ScanFeed
+    {
+    public:
+        explicit ScanFeed(const std::string &proximity_pattern = {});
+
+        void add(std::vector<FeedItem> items);
+        // No more items will be added
+        void close();
+
+        // Next item to load; waits while the walk may add more. False once
+        // everything is claimed and the feed is closed, or on `stop`.
+        bool claim(size_t &index, const std::atomic<bool> &stop);
+        // Item at a claim index, fixing the order up to it (for readahead);
+        // nullptr if the walk has not found that many files yet
+        FeedItem *peek(size_t index);
+        FeedItem &at(size_t index);
+        size_t claimed() const;
+
+    private:
+        struct Pending
+        {
+            FeedItem *item = nullptr;
+            std::string folder;
+            bool named = false;   // Stem contains the pattern
+            size_t rank = SIZE_MAX / 2; // Folder distance to the nearest anchor * 2 + named
+        };
+
+        static constexpr size_t max_anchors_ = 16;
+        static constexpr size_t rank_buckets_ = 32;
+
+        bool commit(size_t count);
+        void rank(Pending &pending, size_t first_anchor) const;
+
+        mutable std::mutex mutex_;
+        std::condition_variable cv_;
+        std::deque<FeedItem> items_;               // Stable: workers keep references
+        std::deque<FeedItem *> order_;             // Claim index -> item
+        std::vector<std::deque<Pending>> pending_; // Added but not ordered yet, by rank
+        size_t next_claim_ = 0;
+        bool closed_ = false;
+        std::string needle_; // Lowercased proximity pattern; empty keeps walk order
+        std::vector<std::string> anchors_;
+    };
+
+    bool compile_pattern(const std::string &search_pattern, ProgressCallback progress_cb);
+
+    void scan_files(ScanFeed &feed,
+                    ProgressCallback progress_cb,
+                    ResultCallback result_cb,
+                    size_t max_files = SIZE_MAX);
+
+    void feed_files(ScanFeed &feed, std::vector<ScanEntry> files);
+
+    void scan_containers(const std::vector<ScanEntry> &containers,
+                         ProgressCallback progress_cb,
+                         ResultCallback result_cb);
+
+    bool full_fingerprint(const std::filesystem::path &path, std::string_view content, size_t length, uint64_t &hash);
+
+    static void sort_by_path(std::vector<ScanEntry> &files);
+
+    void search_file(const ScanEntry &entry,
+                     size_t index,
+                     const MappedFile &file,
+                     const ScanPlan &plan,
+                     const uint64_t *sample_hash,
+                     DedupTable &dedup_table,
+                     ResultSequencer *sequencer,
                      ResultCallback result_cb);
 
-    void search_directory_worker(const std::filesystem::path &dir_path,
-                                 ProgressCallback progress_cb,
-                                 ResultCallback result_cb);
+    // Publishes an item's results, in item order when a sequencer is given
+    void complete_item(ResultSequencer *sequencer, size_t index, size_t root,
+                       std::vector<SearchResult> results, ResultCallback result_cb);
+
+    ScanPlan plan_scan(const std::filesystem::path &file_path, std::string_view content) const;
+    uint64_t readahead_bytes(const ScanEntry &entry) const;
+    std::vector<SearchResult> match_content(const std::filesystem::path &file_path, std::string_view content);
+    // `content` already cut to plan.bytes
+    std::vector<SearchResult> match_content(const std::filesystem::path &file_path, std::string_view content,
+                                            const ScanPlan &plan);
+
+    void publish_results(const std::vector<SearchResult> &results, size_t root, ResultCallback result_cb);
 
-    std::vector<std::filesystem::path> collect_files(const std::filesystem::path &directory);
+    static std::vector<SearchResult> as_duplicates(const std::vector<SearchResult> &results,
+                                                   const std::filesystem::path &file_path,
+                                                   const std::filesystem::path &owner);
+
+    bool find_match(std::string_view content, size_t from, size_t &match_pos, size_t &match_len) const;
+
+    std::vector<SearchResult> collect_all_matches(const std::filesystem::path &file_path,
+                                                  std::string_view content,
+                                                  bool is_text);
+
+    // Walks a tree, handing found files to `flush` in small batches
+    void walk_files(const std::filesystem::path &directory, bool apply_size_limits,
+                    const std::function<void(std::vector<ScanEntry> &)> &flush);
+    std::vector<ScanEntry> collect_files(const std::filesystem::path &directory, bool apply_size_limits = true);
+    bool is_extension_allowed(const std::filesystem::path &path) const;
+    bool is_container(const std::filesystem::path &path) const;
 
     mutable std::mutex results_mutex_;
     std::vector<SearchResult> results_;
     std::atomic<bool> searching_{false};
     std::atomic<bool> stop_requested_{false};
+    std::atomic<bool> last_search_completed_{false};
     size_t thread_count_;
+    StageLimits io_limits_{2, 64};
+    StageLimits match_limits_;
+    ScanPipeline::Stats pipeline_stats_;
+    ScanProgress progress_;
+    size_t prefetch_min_depth_ = 0;
+    size_t prefetch_max_depth_ = 256;
 
     size_t min_file_size_ = 100;         // Skip files smaller than 100 bytes
     size_t max_file_size_ = 1024 * 1024; // Skip files larger than 1MB
 
+    bool all_matches_ = false;
+    size_t max_matches_per_file_ = 100;
+    size_t context_bytes_ = 40;
+
+    bool utf16_matching_ = false;
+    bool case_sensitive_ = false;
+    bool whole_word_ = false;
+
+    ScanPolicies scan_policies_{ScanPolicy::Full, ScanPolicy::Full, ScanPolicy::Full, ScanPolicy::Skip};
+    size_t header_scan_bytes_ = 64 * 1024;
+    std::unordered_set<std::string> included_extensions_;
+    std::unordered_set<std::string> excluded_extensions_;
+    IgnoreRules ignore_rules_;
+
+    bool search_paks_ = true;
+
+    bool ordered_output_ = false;
+    size_t result_limit_ = 0;
+    std::atomic<bool> result_limit_reached_{false};
+
+    bool deduplicate_ = false;
+    content_fingerprint::FingerprintCache fingerprint_cache_;
+    std::atomic<size_t> duplicate_files_{0};
+    std::atomic<uint64_t> bytes_not_rematched_{0};
+
     std::regex compiled_pattern_; // Cached compiled regex
+    bool use_literal_matcher_ = false;
+    scan_kernels::MultiLiteralMatcher literal_matcher_;
 };
\ No newline at end of file
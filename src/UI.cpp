@@ -6,7 +6,10 @@
 #include <chrono>
 #include <filesystem>
 #include <algorithm>
-#include <sstream>
+#include <cstdio>
+#include <fstream>
+#include "CommandPipe.h"
+#include "ResultExporter.h"
 
 #ifdef _WIN32
 #include <windows.h>
@@ -17,6 +20,17 @@
 
 using namespace ftxui;
 
+#ifndef _WIN32
+// Starts the first clipboard tool found (X11, Wayland, macOS) with its
+// stdin connected to `pipe`. No shell is involved, so text is never parsed.
+bool openClipboardPipe(CommandPipe &pipe)
+{
+    return pipe.open_first({{"xclip", "-selection", "clipboard"},
+                            {"wl-copy"},
+                            {"pbcopy"}});
+}
+#endif
+
 // Function to set clipboard content
 void setClipboard(const std::string &text)
 {
@@ -37,9 +51,12 @@ void setClipboard(const std::string &text)
 
     CloseClipboard();
 #else
-    // For Linux/macOS, try xclip or pbcopy
-    std::string command = "echo '" + text + "' | xclip -selection clipboard 2>/dev/null || echo '" + text + "' | pbcopy 2>/dev/null";
-    system(command.c_str());
+    CommandPipe pipe;
+    if (openClipboardPipe(pipe))
+    {
+        pipe.write(text);
+        pipe.close();
+    }
 #endif
 }
 
@@ -93,48 +110,167 @@ std::string getClipboard()
 #endif
 }
 
+// Result filter match; `filter_lower` is already lowercase
+bool matchesFilter(const std::string &line, const std::string &filter_lower)
+{
+    if (filter_lower.empty())
+        return true;
+
+    std::string line_lower = line;
+    std::transform(line_lower.begin(), line_lower.end(), line_lower.begin(), ::tolower);
+    return line_lower.find(filter_lower) != std::string::npos;
+}
+
+// Live scan rates for the progress line: "1250 files/s  84.2 MB/s  ETA 0:42"
+std::string describeThroughput(const ScanProgress::Sample &sample)
+{
+    char buffer[96];
+    int length = std::snprintf(buffer, sizeof(buffer), "%.0f files/s  %.1f MB/s",
+                               sample.files_per_second, sample.bytes_per_second / (1024.0 * 1024.0));
+    std::string description(buffer, static_cast<size_t>(std::max(length, 0)));
+
+    if (sample.eta_seconds >= 0.0)
+    {
+        auto seconds = static_cast<unsigned long long>(sample.eta_seconds + 0.5);
+        std::snprintf(buffer, sizeof(buffer), "  ETA %llu:%02llu", seconds / 60, seconds % 60);
+        description += buffer;
+    }
+    return description;
+}
+
 SearchAssetsUI::SearchAssetsUI() : screen_(ScreenInteractive::Fullscreen())
 {
     search_engine_ = std::make_unique<SearchEngine>();
+    for (const auto &extension : SearchEngine::default_excluded_extensions())
+    {
+        excluded_extensions_str_ += (excluded_extensions_str_.empty() ? "" : " ") + extension;
+    }
     // Initialize filtered results as empty
     filtered_result_lines_.clear();
     create_ui();
+    live_thread_ = std::thread([this]()
+                               { live_search_loop(); });
 }
 
 SearchAssetsUI::~SearchAssetsUI()
 {
+    stop_refresh_thread();
+
+    {
+        std::lock_guard<std::mutex> lock(live_mutex_);
+        live_shutdown_ = true;
+    }
+    live_cv_.notify_one();
+
     if (search_engine_)
     {
         search_engine_->stop_search();
     }
+
+    if (live_thread_.joinable())
+    {
+        live_thread_.join();
+    }
 }
 
 void SearchAssetsUI::run()
 {
-    auto refresh_loop = std::thread([this]()
-                                    {
-        while (true) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
-            if (needs_refresh_) {
-                screen_.PostEvent(Event::Custom);
-                needs_refresh_ = false;
-            }
-        } });
-    refresh_loop.detach();
+    {
+        std::lock_guard<std::mutex> lock(refresh_mutex_);
+        refresh_shutdown_ = false;
+    }
+    refresh_thread_ = std::thread([this]()
+                                  { refresh_loop(); });
 
     screen_.Loop(main_container_);
+
+    // No redraw may be posted once the loop is gone
+    stop_refresh_thread();
+}
+
+void SearchAssetsUI::set_refresh_rate(int frames_per_second)
+{
+    std::lock_guard<std::mutex> lock(refresh_mutex_);
+    frame_interval_ = std::chrono::microseconds(1000000 / std::max(1, frames_per_second));
+}
+
+void SearchAssetsUI::request_refresh()
+{
+    {
+        std::lock_guard<std::mutex> lock(refresh_mutex_);
+        if (refresh_pending_)
+            return;
+        refresh_pending_ = true;
+    }
+    refresh_cv_.notify_one();
+}
+
+void SearchAssetsUI::refresh_loop()
+{
+    std::unique_lock<std::mutex> lock(refresh_mutex_);
+    auto last_post = std::chrono::steady_clock::now() - frame_interval_;
+    auto wake = [this]()
+    { return refresh_pending_ || refresh_shutdown_; };
+
+    while (true)
+    {
+        // Idle: sleep until a producer asks. While a search runs the progress
+        // line is sampled from the engine, so wake for it as well
+        if (is_searching_)
+            refresh_cv_.wait_for(lock, progress_interval_, wake);
+        else
+            refresh_cv_.wait(lock, wake);
+        if (refresh_shutdown_)
+            break;
+
+        // Everything requested until the next frame is due becomes one redraw
+        refresh_cv_.wait_until(lock, last_post + frame_interval_, [this]()
+                               { return refresh_shutdown_; });
+        if (refresh_shutdown_)
+            break;
+
+        refresh_pending_ = false;
+        lock.unlock();
+        screen_.PostEvent(Event::Custom);
+        lock.lock();
+        last_post = std::chrono::steady_clock::now();
+    }
+}
+
+void SearchAssetsUI::stop_refresh_thread()
+{
+    {
+        std::lock_guard<std::mutex> lock(refresh_mutex_);
+        refresh_shutdown_ = true;
+    }
+    refresh_cv_.notify_one();
+
+    if (refresh_thread_.joinable())
+    {
+        refresh_thread_.join();
+    }
 }
 
 void SearchAssetsUI::create_ui()
 {
     // Input components with paste support
-    input_search_ = Input(&search_pattern_, "Enter search pattern... (press Enter to search)");
+    InputOption search_option;
+    search_option.on_change = [this]()
+    {
+        if (live_search_ && use_reference_graph_)
+            perform_reference_lookup();
+        else if (live_search_)
+            schedule_live_search();
+    };
+    input_search_ = Input(&search_pattern_, "Enter search pattern... (press Enter to search)", search_option);
     input_search_ = CatchEvent(input_search_, [this](Event event)
                                {
         if (event == Event::F6) {
             std::string clipboard_content = getClipboard();
             if (!clipboard_content.empty()) {
                 search_pattern_ += clipboard_content;
+                if (live_search_)
+                    schedule_live_search();
             }
             return true;
         }
@@ -156,9 +292,23 @@ void SearchAssetsUI::create_ui()
 
     input_min_size_ = Input(&min_file_size_str_, "Min size (KB)");
     input_max_size_ = Input(&max_file_size_str_, "Max size (KB)");
+    input_excluded_ext_ = Input(&excluded_extensions_str_, "Extensions to skip, e.g. .ubulk .wav");
+    input_reference_depth_ = Input(&reference_depth_str_, "Depth");
+    input_result_limit_ = Input(&result_limit_str_, "0 = all");
+    input_export_path_ = Input(&export_path_, ".txt, .csv or .ndjson");
 
     checkbox_plugins_ = Checkbox("Search in Plugins/*/Content", &search_plugins_);
     checkbox_unreal_prefixes_ = Checkbox("Remove Unreal prefixes (A,U,F,S,T,E,I)", &remove_unreal_prefixes_);
+    checkbox_live_search_ = Checkbox("Search as you type", &live_search_);
+    checkbox_case_sensitive_ = Checkbox("Match case", &case_sensitive_);
+    checkbox_whole_word_ = Checkbox("Whole word", &whole_word_);
+    checkbox_all_matches_ = Checkbox("All matches (line + context)", &all_matches_);
+    checkbox_utf16_ = Checkbox("UTF-16 strings too", &utf16_matching_);
+    checkbox_headers_only_ = Checkbox("Package headers only", &package_headers_only_);
+    checkbox_dedup_ = Checkbox("Skip identical files", &skip_identical_files_);
+    checkbox_paks_ = Checkbox("Search inside .pak", &search_paks_);
+    checkbox_reference_graph_ = Checkbox("Graph lookup", &use_reference_graph_);
+    checkbox_ordered_ = Checkbox("Sorted by path", &ordered_output_);
 
     // Buttons
     button_search_ = Button("Search", [this]()
@@ -171,6 +321,10 @@ void SearchAssetsUI::create_ui()
                                    { copy_selected_result(); });
     button_copy_all_ = Button("Copy All Results", [this]()
                               { copy_all_results(); });
+    button_build_graph_ = Button("Build Ref Graph", [this]()
+                                 { build_reference_graph(); });
+    button_export_ = Button("Export Results", [this]()
+                            { export_results(); });
 
     // Results list - use filtered results with click handler
     results_list_ = Menu(&filtered_result_lines_, &selected_result_);
@@ -178,7 +332,13 @@ void SearchAssetsUI::create_ui()
     // Main layout
     auto input_section = Container::Vertical({Container::Vertical({Container::Horizontal({Renderer([this]()
                                                                                                    { return text("Search Pattern:") | bold; }),
-                                                                                          checkbox_unreal_prefixes_ | color(Color::Orange1)}),
+                                                                                          checkbox_unreal_prefixes_ | color(Color::Orange1),
+                                                                                          Renderer([]()
+                                                                                                   { return text("   "); }),
+                                                                                          checkbox_case_sensitive_ | color(Color::Orange1),
+                                                                                          Renderer([]()
+                                                                                                   { return text("   "); }),
+                                                                                          checkbox_whole_word_ | color(Color::Orange1)}),
                                                                    Renderer(input_search_, [this]()
                                                                             { return input_search_->Render() | border; })}),
                                               Renderer(input_path_, [this]()
@@ -189,8 +349,44 @@ void SearchAssetsUI::create_ui()
                                                                                              input_min_size_->Render() | border}); }),
                                                                      Renderer(input_max_size_, [this]()
                                                                               { return vbox({text("Max Size (KB):") | bold,
-                                                                                             input_max_size_->Render() | border}); })}),
-                                              checkbox_plugins_ | color(Color::Orange1)});
+                                                                                             input_max_size_->Render() | border}); }),
+                                                                     Renderer(input_reference_depth_, [this]()
+                                                                              { return vbox({text("Ref Depth:") | bold,
+                                                                                             input_reference_depth_->Render() | border}); }),
+                                                                     Renderer(input_result_limit_, [this]()
+                                                                              { return vbox({text("Max Results:") | bold,
+                                                                                             input_result_limit_->Render() | border}); }),
+                                                                     Renderer(input_excluded_ext_, [this]()
+                                                                              { return vbox({text("Skip Extensions:") | bold,
+                                                                                             input_excluded_ext_->Render() | border}) |
+                                                                                       flex; }),
+                                                                     Renderer(input_export_path_, [this]()
+                                                                              { return vbox({text("Export File:") | bold,
+                                                                                             input_export_path_->Render() | border}) |
+                                                                                       size(WIDTH, EQUAL, 28); })}),
+                                              Container::Horizontal({checkbox_plugins_ | color(Color::Orange1),
+                                                                     Renderer([]()
+                                                                              { return text("   "); }),
+                                                                     checkbox_live_search_ | color(Color::Orange1),
+                                                                     Renderer([]()
+                                                                              { return text("   "); }),
+                                                                     checkbox_dedup_ | color(Color::Orange1),
+                                                                     Renderer([]()
+                                                                              { return text("   "); }),
+                                                                     checkbox_paks_ | color(Color::Orange1)}),
+                                              Container::Horizontal({checkbox_all_matches_ | color(Color::Orange1),
+                                                                     Renderer([]()
+                                                                              { return text("   "); }),
+                                                                     checkbox_utf16_ | color(Color::Orange1),
+                                                                     Renderer([]()
+                                                                              { return text("   "); }),
+                                                                     checkbox_headers_only_ | color(Color::Orange1),
+                                                                     Renderer([]()
+                                                                              { return text("   "); }),
+                                                                     checkbox_reference_graph_ | color(Color::Orange1),
+                                                                     Renderer([]()
+                                                                              { return text("   "); }),
+                                                                     checkbox_ordered_ | color(Color::Orange1)})});
 
     // Filter section with copy button
     auto filter_section = Container::Vertical({Renderer([this]()
@@ -202,10 +398,14 @@ void SearchAssetsUI::create_ui()
                                                                       button_stop_,
                                                                       button_clear_,
                                                                       button_copy_selected_,
-                                                                      button_copy_all_})});
+                                                                      button_copy_all_,
+                                                                      button_export_,
+                                                                      button_build_graph_})});
 
     auto results_section = Renderer(results_list_, [this]()
                                     {
+        take_pending_results();
+
         // Update filtered results if filter changed
         static std::string last_filter = result_filter_;
         if (last_filter != result_filter_) {
@@ -213,9 +413,15 @@ void SearchAssetsUI::create_ui()
             update_filtered_results();
         }
 
-        auto total_results = result_lines_.size();
+        auto total_results = result_rows_.size();
         auto filtered_results = filtered_result_lines_.size();
 
+        std::string progress_message;
+        {
+            std::lock_guard<std::mutex> lock(progress_mutex_);
+            progress_message = progress_message_;
+        }
+
         auto header = hbox({
             text("Results: ") | bold,
             text(std::to_string(filtered_results)) | color(Color::Green),
@@ -227,10 +433,34 @@ void SearchAssetsUI::create_ui()
                       text(last_copied_item_) | color(Color::Yellow)}) :
                 text(""),
             text("  ") | dim,
-            text(progress_message_) | dim
+            text(progress_message) | dim
         });
 
-        if (is_searching_) {
+        auto telemetry = is_searching_ ? search_engine_->sample_progress() : ScanProgress::Sample{};
+        if (telemetry.active && telemetry.files_total > 0) {
+            float ratio = static_cast<float>(telemetry.files_done) / telemetry.files_total;
+            Elements lines = {
+                header,
+                hbox({
+                    text("Progress: "),
+                    gauge(ratio) | size(WIDTH, EQUAL, 30),
+                    text(" " + std::to_string(telemetry.files_done) + "/" + std::to_string(telemetry.files_total) + " files  "),
+                    text(describeThroughput(telemetry)) | color(Color::Cyan)
+                })
+            };
+
+            // Plugin roots are all named Content: show their parent too
+            if (telemetry.roots.size() > 1) {
+                Elements roots;
+                for (const auto &root : telemetry.roots) {
+                    auto name = (root.root.parent_path().filename() / root.root.filename()).string();
+                    roots.push_back(text(name + " " + std::to_string(root.files_done) + "/" +
+                                         std::to_string(root.files_total) + " (" + std::to_string(root.hits) + " hits)  ") | dim);
+                }
+                lines.push_back(hbox(std::move(roots)));
+            }
+            header = vbox(std::move(lines));
+        } else if (is_searching_) {
             auto progress = progress_current_.load();
             auto total = progress_total_.load();
 
@@ -303,22 +533,207 @@ void SearchAssetsUI::create_ui()
 }
 
 void SearchAssetsUI::perform_search()
+{
+    if (use_reference_graph_)
+    {
+        perform_reference_lookup();
+        return;
+    }
+
+    if (live_search_)
+    {
+        schedule_live_search();
+        return;
+    }
+
+    if (search_pattern_.empty() || !claim_engine())
+    {
+        return;
+    }
+
+    apply_file_size_limits(min_file_size_str_, max_file_size_str_);
+    apply_result_limit(result_limit_str_);
+    search_engine_->set_all_matches(all_matches_);
+    search_engine_->set_utf16_matching(utf16_matching_);
+    search_engine_->set_case_sensitive(case_sensitive_);
+    search_engine_->set_whole_word(whole_word_);
+    apply_file_type_filters(package_headers_only_, excluded_extensions_str_);
+    search_engine_->set_deduplication(skip_identical_files_);
+    search_engine_->set_pak_search(search_paks_);
+    search_engine_->set_ordered_output(ordered_output_);
+
+    // Sanitize search pattern if Unreal prefix removal is enabled
+    std::string actual_search_pattern = search_pattern_;
+    if (remove_unreal_prefixes_)
+    {
+        actual_search_pattern = remove_unreal_prefix(search_pattern_);
+    }
+
+    reset_search();
+    request_refresh();
+
+    apply_ignore_rules(custom_path_);
+    std::vector<std::filesystem::path> search_paths = resolve_search_paths(custom_path_, search_plugins_);
+
+    if (search_paths.empty())
+    {
+        is_searching_ = false;
+        update_progress("No search paths available", 0, 0);
+        return;
+    }
+
+    // Start search in separate thread
+    std::thread search_thread([this, search_paths, actual_search_pattern]()
+                              {
+        search_engine_->search(
+            actual_search_pattern,
+            search_paths,
+            [this](const std::string& message, size_t current, size_t total) {
+                update_progress(message, current, total);
+            },
+            [this](const SearchResult& result) {
+                add_result(result);
+            }
+        );
+        if (search_engine_->result_limit_reached()) {
+            update_progress("Stopped at the result limit", 0, 0);
+        }
+        is_searching_ = false;
+        request_refresh(); });
+    search_thread.detach();
+}
+
+bool SearchAssetsUI::claim_engine()
+{
+    // Options are plain engine fields read by the scan workers, and a second
+    // search() returns at once: only the owner may set them and search
+    bool idle = false;
+    return is_searching_.compare_exchange_strong(idle, true);
+}
+
+std::filesystem::path SearchAssetsUI::reference_graph_file() const
+{
+    // Kept next to the searched content: the custom path or the project root
+    if (!custom_path_.empty())
+    {
+        return std::filesystem::path(custom_path_) / ReferenceGraph::default_file_name;
+    }
+    return ReferenceGraph::default_file_name;
+}
+
+void SearchAssetsUI::perform_reference_lookup()
 {
     if (is_searching_)
     {
         return;
     }
 
-    if (search_pattern_.empty())
+    std::string asset = remove_unreal_prefixes_ ? remove_unreal_prefix(search_pattern_) : search_pattern_;
+
+    queue_results_reset();
+    take_pending_results();
+
+    auto graph_file = reference_graph_file();
+    std::error_code ec;
+    auto graph_time = std::filesystem::last_write_time(graph_file, ec);
+    if (ec)
+    {
+        reference_graph_.reset();
+        update_progress("No reference graph yet - press Build Ref Graph", 0, 0);
+        return;
+    }
+
+    if (!reference_graph_ || reference_graph_path_ != graph_file || reference_graph_time_ != graph_time)
     {
+        auto graph = std::make_unique<ReferenceGraph>();
+        if (!graph->load(graph_file))
+        {
+            reference_graph_.reset();
+            update_progress("Could not read " + graph_file.string() + " - rebuild it", 0, 0);
+            return;
+        }
+        reference_graph_ = std::move(graph);
+        reference_graph_path_ = graph_file;
+        reference_graph_time_ = graph_time;
+    }
+
+    if (asset.empty())
+    {
+        update_progress("", 0, 0);
         return;
     }
 
+    uint32_t depth = 1;
+    try
+    {
+        depth = static_cast<uint32_t>(std::max(1, std::stoi(reference_depth_str_)));
+    }
+    catch (const std::exception &)
+    {
+        // Keep direct referencers only if parsing fails
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    auto referencers = reference_graph_->find_referencers(asset, depth);
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+    for (const auto &referencer : referencers)
+    {
+        std::string name = std::filesystem::path(referencer.package_path).filename().string();
+        std::string line = name;
+        if (referencer.depth > 1)
+        {
+            line += "  (depth " + std::to_string(referencer.depth) + ")";
+        }
+        add_result_line(line, name);
+    }
+
+    update_progress(std::to_string(referencers.size()) + " referencers from graph in " +
+                        std::to_string(elapsed.count()) + " us",
+                    0, 0);
+}
+
+void SearchAssetsUI::build_reference_graph()
+{
+    if (!claim_engine())
+    {
+        return;
+    }
+
+    apply_file_type_filters(package_headers_only_, excluded_extensions_str_);
+    apply_ignore_rules(custom_path_);
+    auto search_paths = resolve_search_paths(custom_path_, search_plugins_);
+    if (search_paths.empty())
+    {
+        is_searching_ = false;
+        update_progress("No search paths available", 0, 0);
+        return;
+    }
+
+    request_refresh();
+    auto graph_file = reference_graph_file();
+
+    std::thread build_thread([this, search_paths, graph_file]()
+                             {
+        search_engine_->build_reference_graph(
+            search_paths,
+            graph_file,
+            [this](const std::string& message, size_t current, size_t total) {
+                update_progress(message, current, total);
+            }
+        );
+        is_searching_ = false;
+        request_refresh(); });
+    build_thread.detach();
+}
+
+void SearchAssetsUI::apply_file_size_limits(const std::string &min_kb_str, const std::string &max_kb_str)
+{
     // Update file size limits from UI
     try
     {
-        double min_kb = std::stod(min_file_size_str_);
-        double max_kb = std::stod(max_file_size_str_);
+        double min_kb = std::stod(min_kb_str);
+        double max_kb = std::stod(max_kb_str);
         size_t min_bytes = static_cast<size_t>(min_kb * 1024);
         size_t max_bytes = static_cast<size_t>(max_kb * 1024);
         search_engine_->set_file_size_limits(min_bytes, max_bytes);
@@ -327,23 +742,68 @@ void SearchAssetsUI::perform_search()
     {
         // Use default values if parsing fails
     }
+}
 
-    // Sanitize search pattern if Unreal prefix removal is enabled
-    std::string actual_search_pattern = search_pattern_;
-    if (remove_unreal_prefixes_)
+void SearchAssetsUI::apply_result_limit(const std::string &limit_str)
+{
+    size_t limit = 0;
+    try
     {
-        actual_search_pattern = remove_unreal_prefix(search_pattern_);
+        limit = static_cast<size_t>(std::max(0LL, std::stoll(limit_str)));
     }
+    catch (const std::exception &)
+    {
+        // No limit if parsing fails
+    }
+    search_engine_->set_result_limit(limit);
+}
 
-    reset_search();
-    is_searching_ = true;
+void SearchAssetsUI::apply_file_type_filters(bool package_headers_only, const std::string &excluded_extensions)
+{
+    search_engine_->set_scan_policy(FileKind::UnrealPackage,
+                                    package_headers_only ? ScanPolicy::HeaderOnly : ScanPolicy::Full);
+
+    // Extensions are separated by spaces, commas or semicolons
+    std::vector<std::string> excluded;
+    std::string current;
+    for (char c : excluded_extensions + " ")
+    {
+        if (c == ' ' || c == ',' || c == ';')
+        {
+            if (!current.empty())
+            {
+                excluded.push_back(current);
+                current.clear();
+            }
+        }
+        else
+        {
+            current += c;
+        }
+    }
+    search_engine_->set_extension_filter({}, excluded);
+}
+
+void SearchAssetsUI::apply_ignore_rules(const std::string &custom_path)
+{
+    // Re-read on every search so edits to the file apply immediately.
+    // A file in the custom path wins over the one in the project root.
+    search_engine_->clear_ignore_rules();
+    if (!custom_path.empty() && search_engine_->load_ignore_file(std::filesystem::path(custom_path) / IgnoreRules::file_name))
+    {
+        return;
+    }
+    search_engine_->load_ignore_file(IgnoreRules::file_name);
+}
 
+std::vector<std::filesystem::path> SearchAssetsUI::resolve_search_paths(const std::string &custom_path, bool search_plugins)
+{
     std::vector<std::filesystem::path> search_paths;
 
     // Determine search paths
-    if (!custom_path_.empty())
+    if (!custom_path.empty())
     {
-        search_paths.push_back(std::filesystem::path(custom_path_));
+        search_paths.push_back(std::filesystem::path(custom_path));
     }
     else
     {
@@ -354,22 +814,20 @@ void SearchAssetsUI::perform_search()
         }
 
         // Add plugin paths if enabled
-        if (search_plugins_)
+        if (search_plugins)
         {
             try
             {
                 if (std::filesystem::exists("Plugins"))
                 {
-                    size_t plugin_count = 0;
                     for (const auto &plugin_dir : std::filesystem::directory_iterator("Plugins"))
                     {
                         if (plugin_dir.is_directory())
                         {
                             auto content_path = plugin_dir.path() / "Content";
-                            if (std::filesystem::exists(content_path))
+                            if (std::filesystem::exists(content_path) && !search_engine_->is_ignored(content_path, true))
                             {
                                 search_paths.push_back(content_path);
-                                plugin_count++;
                             }
                         }
                     }
@@ -382,29 +840,211 @@ void SearchAssetsUI::perform_search()
         }
     }
 
-    if (search_paths.empty())
+    return search_paths;
+}
+
+bool SearchAssetsUI::is_refinement(const std::string &previous, const std::string &current,
+                                   bool case_sensitive, bool whole_word)
+{
+    // A longer literal containing the previous one can only match a subset of
+    // its files. Whole words break this: "Door" is not a word inside "DoorFrame".
+    if (whole_word || previous.empty() || current.empty() ||
+        !SearchEngine::is_literal_pattern(previous) || !SearchEngine::is_literal_pattern(current))
     {
-        is_searching_ = false;
-        update_progress("No search paths available", 0, 0);
-        return;
+        return false;
     }
 
-    // Start search in separate thread
-    std::thread search_thread([this, search_paths, actual_search_pattern]()
-                              {
-        search_engine_->search(
-            actual_search_pattern,
-            search_paths,
-            [this](const std::string& message, size_t current, size_t total) {
+    if (case_sensitive)
+    {
+        return current.find(previous) != std::string::npos;
+    }
+
+    std::string previous_lower = previous;
+    std::string current_lower = current;
+    std::transform(previous_lower.begin(), previous_lower.end(), previous_lower.begin(), ::tolower);
+    std::transform(current_lower.begin(), current_lower.end(), current_lower.begin(), ::tolower);
+    return current_lower.find(previous_lower) != std::string::npos;
+}
+
+void SearchAssetsUI::schedule_live_search()
+{
+    LiveRequest request;
+    request.pattern = remove_unreal_prefixes_ ? remove_unreal_prefix(search_pattern_) : search_pattern_;
+    request.custom_path = custom_path_;
+    request.search_plugins = search_plugins_;
+    request.all_matches = all_matches_;
+    request.utf16_matching = utf16_matching_;
+    request.case_sensitive = case_sensitive_;
+    request.whole_word = whole_word_;
+    request.package_headers_only = package_headers_only_;
+    request.excluded_extensions = excluded_extensions_str_;
+    request.skip_identical_files = skip_identical_files_;
+    request.search_paks = search_paks_;
+    request.ordered_output = ordered_output_;
+    request.min_size = min_file_size_str_;
+    request.max_size = max_file_size_str_;
+    request.result_limit = result_limit_str_;
+    request.scope = custom_path_ + '\n' + (search_plugins_ ? "1" : "0") + (all_matches_ ? "1" : "0") +
+                    (utf16_matching_ ? "1" : "0") + (package_headers_only_ ? "1" : "0") +
+                    (case_sensitive_ ? "1" : "0") + (whole_word_ ? "1" : "0") + (search_paks_ ? "1" : "0") +
+                    (ordered_output_ ? "1" : "0") + '\n' +
+                    min_file_size_str_ + '\n' + max_file_size_str_ + '\n' + excluded_extensions_str_ + '\n' +
+                    result_limit_str_;
+
+    {
+        std::lock_guard<std::mutex> lock(live_mutex_);
+
+        // A scan the new pattern refines may finish: its matches become the
+        // candidates for the next one. Anything else is stale, cancel it now.
+        if (request.scope != live_running_scope_ || !is_refinement(live_running_pattern_, request.pattern,
+                                                                   request.case_sensitive, request.whole_word))
+        {
+            // The worker may be between taking its request and entering the
+            // engine, where a bare stop_search() would be cleared again
+            live_cancel_ = true;
+            search_engine_->stop_search();
+        }
+
+        live_request_ = std::move(request);
+        live_pending_ = true;
+        ++live_generation_;
+    }
+    live_cv_.notify_one();
+}
+
+void SearchAssetsUI::live_search_loop()
+{
+    std::unique_lock<std::mutex> lock(live_mutex_);
+
+    while (true)
+    {
+        live_cv_.wait(lock, [this]()
+                      { return live_shutdown_ || live_pending_; });
+        if (live_shutdown_)
+        {
+            return;
+        }
+
+        // Debounce: wait until typing pauses
+        uint64_t generation = live_generation_;
+        while (live_cv_.wait_for(lock, live_debounce_, [this, generation]()
+                                 { return live_shutdown_ || live_generation_ != generation; }))
+        {
+            if (live_shutdown_)
+            {
+                return;
+            }
+            generation = live_generation_;
+        }
+
+        // A manual search or graph build may still hold the engine; keystrokes
+        // meanwhile only replace the request that runs once it is released
+        while (!claim_engine())
+        {
+            if (live_cv_.wait_for(lock, live_engine_retry_, [this]()
+                                  { return live_shutdown_; }))
+            {
+                return;
+            }
+        }
+
+        LiveRequest request = live_request_;
+        live_pending_ = false;
+
+        bool refine = request.scope == live_base_scope_ && is_refinement(live_base_pattern_, request.pattern,
+                                                                         request.case_sensitive, request.whole_word);
+        std::vector<std::filesystem::path> candidates;
+        if (refine)
+        {
+            candidates = live_base_files_;
+        }
+        live_running_pattern_ = request.pattern;
+        live_running_scope_ = request.scope;
+        live_cancel_ = false;
+        lock.unlock();
+
+        queue_results_reset();
+
+        bool completed = false;
+        if (!request.pattern.empty())
+        {
+            apply_file_size_limits(request.min_size, request.max_size);
+            apply_result_limit(request.result_limit);
+            search_engine_->set_all_matches(request.all_matches);
+            search_engine_->set_utf16_matching(request.utf16_matching);
+            search_engine_->set_case_sensitive(request.case_sensitive);
+            search_engine_->set_whole_word(request.whole_word);
+            apply_file_type_filters(request.package_headers_only, request.excluded_extensions);
+            search_engine_->set_deduplication(request.skip_identical_files);
+            search_engine_->set_pak_search(request.search_paks);
+            search_engine_->set_ordered_output(request.ordered_output);
+
+            auto progress_cb = [this](const std::string &message, size_t current, size_t total)
+            {
                 update_progress(message, current, total);
-            },
-            [this](const SearchResult& result) {
+            };
+            auto result_cb = [this](const SearchResult &result)
+            {
                 add_result(result);
+            };
+
+            request_refresh();
+            if (refine)
+            {
+                update_progress("Narrowing " + std::to_string(candidates.size()) + " previous matches...", 0, candidates.size());
+                search_engine_->search_files(request.pattern, candidates, progress_cb, result_cb, &live_cancel_);
             }
-        );
+            else
+            {
+                apply_ignore_rules(request.custom_path);
+                auto search_paths = resolve_search_paths(request.custom_path, request.search_plugins);
+                if (search_paths.empty())
+                {
+                    update_progress("No search paths available", 0, 0);
+                }
+                else
+                {
+                    search_engine_->search(request.pattern, search_paths, progress_cb, result_cb, &live_cancel_);
+                }
+            }
+            completed = search_engine_->last_search_completed();
+            if (search_engine_->result_limit_reached())
+            {
+                update_progress("Stopped at the result limit", 0, 0);
+            }
+        }
+        else
+        {
+            update_progress("", 0, 0);
+        }
+
+        std::vector<std::filesystem::path> matched_files;
+        if (completed)
+        {
+            // All-matches mode reports each file once per match, in a row
+            for (const auto &result : search_engine_->get_results())
+            {
+                if (matched_files.empty() || matched_files.back() != result.file_path)
+                {
+                    matched_files.push_back(result.file_path);
+                }
+            }
+        }
+
+        // Released only once this search's results are read
         is_searching_ = false;
-        needs_refresh_ = true; });
-    search_thread.detach();
+        request_refresh();
+
+        lock.lock();
+        live_running_pattern_.clear();
+        live_running_scope_.clear();
+        if (completed)
+        {
+            live_base_pattern_ = request.pattern;
+            live_base_scope_ = request.scope;
+            live_base_files_ = std::move(matched_files);
+        }
+    }
 }
 
 void SearchAssetsUI::reset_search()
@@ -415,90 +1055,126 @@ void SearchAssetsUI::reset_search()
         search_engine_->clear_results();
     }
 
-    {
-        std::lock_guard<std::mutex> lock(results_mutex_);
-        result_lines_.clear();
-        filtered_result_lines_.clear();
-        selected_result_ = 0;
-    }
+    queue_results_reset();
+    take_pending_results();
 
     result_filter_.clear();
-    last_copied_item_.clear();
 
-    progress_message_ = "";
+    {
+        std::lock_guard<std::mutex> lock(progress_mutex_);
+        progress_message_.clear();
+    }
     progress_current_ = 0;
     progress_total_ = 0;
-    is_searching_ = false;
-    needs_refresh_ = true;
+    // A search still running clears is_searching_ itself once stopped
+    request_refresh();
 }
 
 void SearchAssetsUI::update_progress(const std::string &message, size_t current, size_t total)
 {
-    progress_message_ = message;
+    {
+        std::lock_guard<std::mutex> lock(progress_mutex_);
+        progress_message_ = message;
+    }
     progress_current_ = current;
     progress_total_ = total;
-    needs_refresh_ = true;
+    request_refresh();
 }
 
 void SearchAssetsUI::add_result(const SearchResult &result)
 {
-    std::lock_guard<std::mutex> lock(results_mutex_);
-
     // Show only the filename (without path)
     std::string filename = result.file_path.filename().string();
-    // Check if filename already exists in results to avoid duplicates
-    if (std::find(result_lines_.begin(), result_lines_.end(), filename) == result_lines_.end())
+
+    // In all-matches mode each match gets its own line: where it is, then its context
+    if (search_engine_->all_matches())
     {
-        result_lines_.push_back(filename);
-        // Update filtered results inline to avoid double locking
-        if (result_filter_.empty())
-        {
-            filtered_result_lines_ = result_lines_;
-        }
-        else
-        {
-            filtered_result_lines_.clear();
-            std::string filter_lower = result_filter_;
-            std::transform(filter_lower.begin(), filter_lower.end(), filter_lower.begin(), ::tolower);
+        filename += result.line_number > 0 ? ":" + std::to_string(result.line_number)
+                                           : "@" + std::to_string(result.byte_offset);
+        filename += "  " + result.line_content;
+    }
 
-            for (const auto &line : result_lines_)
-            {
-                std::string line_lower = line;
-                std::transform(line_lower.begin(), line_lower.end(), line_lower.begin(), ::tolower);
+    // Identical copies are listed with the file whose verdict they share
+    if (!result.duplicate_of.empty())
+    {
+        filename += "  (same as " + result.duplicate_of.parent_path().filename().string() + "/" +
+                    result.duplicate_of.filename().string() + ")";
+    }
 
-                if (line_lower.find(filter_lower) != std::string::npos)
-                {
-                    filtered_result_lines_.push_back(line);
-                }
-            }
-        }
-        needs_refresh_ = true;
+    // Copy Selected takes the asset name from the result, not from the listed line
+    add_result_line(filename, result.file_path.stem().string());
+}
+
+void SearchAssetsUI::add_result_line(const std::string &line, const std::string &copy_name)
+{
+    {
+        std::lock_guard<std::mutex> lock(results_mutex_);
+        pending_rows_.push_back({line, copy_name});
     }
+    request_refresh();
 }
 
-void SearchAssetsUI::update_filtered_results()
+void SearchAssetsUI::queue_results_reset()
 {
-    std::lock_guard<std::mutex> lock(results_mutex_);
-    filtered_result_lines_.clear();
+    {
+        std::lock_guard<std::mutex> lock(results_mutex_);
+        pending_rows_.clear();
+        pending_reset_ = true;
+    }
+    request_refresh();
+}
 
-    if (result_filter_.empty())
+void SearchAssetsUI::take_pending_results()
+{
+    std::vector<ResultRow> rows;
+    bool reset = false;
     {
-        filtered_result_lines_ = result_lines_;
+        std::lock_guard<std::mutex> lock(results_mutex_);
+        rows.swap(pending_rows_);
+        reset = pending_reset_;
+        pending_reset_ = false;
     }
-    else
+
+    if (reset)
     {
-        std::string filter_lower = result_filter_;
-        std::transform(filter_lower.begin(), filter_lower.end(), filter_lower.begin(), ::tolower);
+        result_rows_.clear();
+        listed_lines_.clear();
+        filtered_result_lines_.clear();
+        filtered_rows_.clear();
+        selected_result_ = 0;
+        last_copied_item_.clear();
+    }
+
+    std::string filter_lower = result_filter_;
+    std::transform(filter_lower.begin(), filter_lower.end(), filter_lower.begin(), ::tolower);
+    for (auto &row : rows)
+    {
+        // Skip lines already listed (all-matches mode can repeat one)
+        if (!listed_lines_.insert(row.line).second)
+            continue;
 
-        for (const auto &result : result_lines_)
+        if (matchesFilter(row.line, filter_lower))
         {
-            std::string result_lower = result;
-            std::transform(result_lower.begin(), result_lower.end(), result_lower.begin(), ::tolower);
+            filtered_result_lines_.push_back(row.line);
+            filtered_rows_.push_back(result_rows_.size());
+        }
+        result_rows_.push_back(std::move(row));
+    }
+}
 
-            if (result_lower.find(filter_lower) != std::string::npos)
-            {
-                filtered_result_lines_.push_back(result);
-            }
+void SearchAssetsUI::update_filtered_results()
+{
+    filtered_result_lines_.clear();
+    filtered_rows_.clear();
+
+    std::string filter_lower = result_filter_;
+    std::transform(filter_lower.begin(), filter_lower.end(), filter_lower.begin(), ::tolower);
+    for (size_t row = 0; row < result_rows_.size(); ++row)
+    {
+        if (matchesFilter(result_rows_[row].line, filter_lower))
+        {
+            filtered_result_lines_.push_back(result_rows_[row].line);
+            filtered_rows_.push_back(row);
         }
     }
 
@@ -507,7 +1183,7 @@ void SearchAssetsUI::update_filtered_results()
         selected_result_ = 0;
     }
 
-    needs_refresh_ = true;
+    request_refresh();
 }
 
 std::string SearchAssetsUI::remove_unreal_prefix(const std::string &filename)
@@ -541,55 +1217,118 @@ std::string SearchAssetsUI::remove_unreal_prefix(const std::string &filename)
 
 void SearchAssetsUI::copy_selected_result()
 {
-    std::lock_guard<std::mutex> lock(results_mutex_);
-
-    if (filtered_result_lines_.empty() ||
-        selected_result_ < 0 ||
-        selected_result_ >= static_cast<int>(filtered_result_lines_.size()))
+    std::string selected_item;
+    if (selected_result_ >= 0 && selected_result_ < static_cast<int>(filtered_rows_.size()))
     {
-        last_copied_item_ = "No result selected";
-        needs_refresh_ = true;
-        return;
+        selected_item = result_rows_[filtered_rows_[selected_result_]].copy_name;
     }
 
-    std::string selected_item = filtered_result_lines_[selected_result_];
-
-    // Remove file extension
-    size_t dot_pos = selected_item.find_last_of('.');
-    if (dot_pos != std::string::npos)
+    if (selected_item.empty())
     {
-        selected_item = selected_item.substr(0, dot_pos);
+        last_copied_item_ = "No result selected";
+        request_refresh();
+        return;
     }
 
     setClipboard(selected_item);
     last_copied_item_ = selected_item;
-    needs_refresh_ = true;
+    request_refresh();
 }
 
 void SearchAssetsUI::copy_all_results()
 {
-    std::lock_guard<std::mutex> lock(results_mutex_);
-
-    if (filtered_result_lines_.empty())
+    // The listed lines belong to the UI thread: scan threads adding results
+    // never wait on the clipboard tool
+    const auto &lines = filtered_result_lines_;
+    if (lines.empty())
     {
         last_copied_item_ = "No results to copy";
-        needs_refresh_ = true;
+        request_refresh();
         return;
     }
 
-    // Create a formatted string with all results
-    std::stringstream ss;
-    ss << "Search Results (" << filtered_result_lines_.size() << " items):\n";
-    ss << "====================================\n";
+    // Stream the formatted list into the clipboard tool chunk by chunk. The
+    // Win32 clipboard takes a single buffer, so it is built in memory there.
+#ifdef _WIN32
+    std::string all_results;
+    ResultExporter exporter(ExportFormat::Text, [&all_results](std::string_view chunk)
+                            { all_results.append(chunk); return true; });
+#else
+    CommandPipe pipe;
+    if (!openClipboardPipe(pipe))
+    {
+        last_copied_item_ = "No clipboard tool found (xclip, wl-copy or pbcopy)";
+        request_refresh();
+        return;
+    }
+    ResultExporter exporter(ExportFormat::Text, [&pipe](std::string_view chunk)
+                            { return pipe.write(chunk); });
+#endif
 
-    for (size_t i = 0; i < filtered_result_lines_.size(); ++i)
+    exporter.begin(lines.size());
+    for (const auto &line : lines)
     {
-        ss << (i + 1) << ". " << filtered_result_lines_[i] << "\n";
+        if (!exporter.add_line(line))
+            break;
     }
+    bool copied = exporter.finish();
 
-    std::string all_results = ss.str();
+#ifdef _WIN32
     setClipboard(all_results);
+#else
+    copied = pipe.close() && copied;
+#endif
+
+    last_copied_item_ = copied ? std::to_string(lines.size()) + " results copied to clipboard"
+                               : "Copy to clipboard failed";
+    request_refresh();
+}
+
+void SearchAssetsUI::export_results()
+{
+    const std::filesystem::path file(export_path_);
+    auto format = ResultExporter::format_for(file);
+    if (!format)
+    {
+        last_copied_item_ = "Export file must end in .txt, .csv or .ndjson";
+        request_refresh();
+        return;
+    }
+
+    std::ofstream out(file, std::ios::binary | std::ios::trunc);
+    if (!out)
+    {
+        last_copied_item_ = "Cannot write " + file.string();
+        request_refresh();
+        return;
+    }
+
+    ResultExporter exporter(*format, [&out](std::string_view chunk)
+                            { out.write(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+                              return static_cast<bool>(out); });
+
+    // Engine results carry the path, location and context as separate
+    // fields; graph lookups only produce display lines
+    const size_t engine_results = search_engine_->result_count();
+    if (engine_results > 0)
+    {
+        exporter.begin(engine_results);
+        search_engine_->for_each_result([&exporter](const SearchResult &result)
+                                        { return exporter.add(result); });
+    }
+    else
+    {
+        exporter.begin(result_rows_.size());
+        for (const auto &row : result_rows_)
+        {
+            if (!exporter.add_line(row.line))
+                break;
+        }
+    }
 
-    last_copied_item_ = std::to_string(filtered_result_lines_.size()) + " results copied to clipboard";
-    needs_refresh_ = true;
+    bool exported = exporter.finish();
+    out.close();
+    last_copied_item_ = exported && out ? std::to_string(exporter.count()) + " results exported to " + file.string()
+                                        : "Export to " + file.string() + " failed";
+    request_refresh();
 }
\ No newline at end of file
@@ -8,6 +8,12 @@
 #include <vector>
 #include <atomic>
 #include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <unordered_set>
 
 #include "SearchEngine.h"
 
@@ -19,15 +25,40 @@ public:
 
     void run();
 
+    // Upper bound on redraws; bursts of results within a frame are coalesced
+    void set_refresh_rate(int frames_per_second);
+
 private:
+    friend class UiBenchmark; // bench/: drives the component tree headless
+
     void create_ui();
+    void request_refresh();
+    void refresh_loop();
+    void stop_refresh_thread();
     void update_progress(const std::string &message, size_t current, size_t total);
     void add_result(const SearchResult &result);
+    void add_result_line(const std::string &line, const std::string &copy_name);
+    void perform_reference_lookup();
+    void build_reference_graph();
+    std::filesystem::path reference_graph_file() const;
     void perform_search();
+    bool claim_engine();
+    void schedule_live_search();
+    void live_search_loop();
+    void apply_file_size_limits(const std::string &min_kb, const std::string &max_kb);
+    void apply_result_limit(const std::string &limit_str);
+    void apply_file_type_filters(bool package_headers_only, const std::string &excluded_extensions);
+    void apply_ignore_rules(const std::string &custom_path);
+    std::vector<std::filesystem::path> resolve_search_paths(const std::string &custom_path, bool search_plugins);
+    static bool is_refinement(const std::string &previous, const std::string &current,
+                              bool case_sensitive, bool whole_word);
     void reset_search();
+    void queue_results_reset();
+    void take_pending_results();
     void update_filtered_results();
     void copy_selected_result();
     void copy_all_results();
+    void export_results();
     std::string remove_unreal_prefix(const std::string& filename);
 
     // UI State
@@ -36,24 +67,95 @@ private:
     std::string result_filter_{""};
     bool search_plugins_{false};
     bool remove_unreal_prefixes_{true};
+    bool live_search_{false};
+    bool all_matches_{false};
+    bool utf16_matching_{true};
+    bool case_sensitive_{false};
+    bool whole_word_{false};
+    bool package_headers_only_{false};
+    bool skip_identical_files_{false};
+    bool search_paks_{true};
+    bool ordered_output_{false};
+    bool use_reference_graph_{false};
+    std::string reference_depth_str_{"1"};
+    std::string result_limit_str_{"0"};
+    std::string excluded_extensions_str_;
+    std::string export_path_{"search_results.ndjson"};
 
     // File size limits (in KB for easier UI)
     std::string min_file_size_str_{"0.1"}; // 100 bytes = 0.1 KB
     std::string max_file_size_str_{"1000"};
 
-    // Search state
+    // Search state. Whoever sets is_searching_ (claim_engine) owns the engine
+    // and its options until it clears the flag after the search returns.
     std::atomic<bool> is_searching_{false};
+    std::mutex progress_mutex_; // Guards the message; file and byte counts are sampled from the engine
     std::string progress_message_;
     std::atomic<size_t> progress_current_{0};
     std::atomic<size_t> progress_total_{0};
 
     // Results
-    mutable std::mutex results_mutex_;
-    std::vector<std::string> result_lines_;
+    struct ResultRow
+    {
+        std::string line;      // As listed
+        std::string copy_name; // What Copy Selected puts on the clipboard
+    };
+    // Any thread queues rows; the UI thread takes them before it draws, so
+    // the listed rows and the menu over them are never shared
+    std::mutex results_mutex_;
+    std::vector<ResultRow> pending_rows_;
+    bool pending_reset_{false}; // Clear the list and status before taking pending_rows_
+
+    // UI thread only
+    std::vector<ResultRow> result_rows_;
+    std::unordered_set<std::string> listed_lines_;
     std::vector<std::string> filtered_result_lines_;
+    std::vector<size_t> filtered_rows_; // Row of each filtered line
     int selected_result_{0};
     std::string last_copied_item_;
 
+    // Search-as-you-type: keystrokes are debounced into a single worker that
+    // narrows the previous matches when the new literal pattern extends them
+    struct LiveRequest
+    {
+        std::string pattern;
+        std::string scope; // custom path, match options and size limits
+        std::string custom_path;
+        bool search_plugins{false};
+        bool all_matches{false};
+        bool utf16_matching{false};
+        bool case_sensitive{false};
+        bool whole_word{false};
+        bool package_headers_only{false};
+        bool skip_identical_files{false};
+        bool search_paks{false};
+        bool ordered_output{false};
+        std::string excluded_extensions;
+        std::string min_size;
+        std::string max_size;
+        std::string result_limit;
+    };
+    static constexpr std::chrono::milliseconds live_debounce_{150};
+    static constexpr std::chrono::milliseconds live_engine_retry_{50}; // While another search holds the engine
+    std::thread live_thread_;
+    std::mutex live_mutex_;
+    std::condition_variable live_cv_;
+    LiveRequest live_request_;
+    uint64_t live_generation_{0};
+    bool live_pending_{false};
+    bool live_shutdown_{false};
+    std::string live_running_pattern_;
+    std::string live_running_scope_;
+    std::atomic<bool> live_cancel_{false}; // Stops the running request, even before it reaches the engine
+    std::string live_base_pattern_;
+    std::string live_base_scope_;
+    std::vector<std::filesystem::path> live_base_files_;
+
+    // Reverse-reference graph, reloaded when the file on disk changes
+    std::unique_ptr<ReferenceGraph> reference_graph_;
+    std::filesystem::path reference_graph_path_;
+    std::filesystem::file_time_type reference_graph_time_;
+
     // Components
     ftxui::Component main_container_;
     ftxui::Component input_search_;
@@ -63,16 +165,39 @@ private:
     ftxui::Component input_max_size_;
     ftxui::Component checkbox_plugins_;
     ftxui::Component checkbox_unreal_prefixes_;
+    ftxui::Component checkbox_live_search_;
+    ftxui::Component checkbox_case_sensitive_;
+    ftxui::Component checkbox_whole_word_;
+    ftxui::Component checkbox_all_matches_;
+    ftxui::Component checkbox_utf16_;
+    ftxui::Component checkbox_headers_only_;
+    ftxui::Component checkbox_dedup_;
+    ftxui::Component checkbox_paks_;
+    ftxui::Component checkbox_reference_graph_;
+    ftxui::Component checkbox_ordered_;
+    ftxui::Component input_reference_depth_;
+    ftxui::Component input_result_limit_;
+    ftxui::Component button_build_graph_;
+    ftxui::Component input_excluded_ext_;
+    ftxui::Component input_export_path_;
     ftxui::Component button_search_;
     ftxui::Component button_stop_;
     ftxui::Component button_clear_;
     ftxui::Component button_copy_selected_;
     ftxui::Component button_copy_all_;
+    ftxui::Component button_export_;
     ftxui::Component results_list_;
 
     ftxui::ScreenInteractive screen_;
     std::unique_ptr<SearchEngine> search_engine_;
 
-    // UI refresh
-    std::atomic<bool> needs_refresh_{false};
+    // UI refresh: producers flag a pending redraw and the refresher posts at
+    // most one event per frame, sleeping while nothing changes
+    std::thread refresh_thread_;
+    std::mutex refresh_mutex_;
+    std::condition_variable refresh_cv_;
+    bool refresh_pending_{false};
+    bool refresh_shutdown_{false};
+    std::chrono::microseconds frame_interval_{1000000 / 60};
+    static constexpr std::chrono::milliseconds progress_interval_{100};
 };
\ No newline at end of file